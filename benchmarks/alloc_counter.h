@@ -0,0 +1,119 @@
+#pragma once
+
+// Подсчёт выделений памяти через замену глобальных operator new и operator delete.
+// Заголовок подключается только в файл с main: замена действует на всю программу
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace bench
+{
+    struct AllocationCounters
+    {
+        std::atomic<size_t> count{0};      // вызовов operator new
+        std::atomic<size_t> live_bytes{0}; // выделено и ещё не освобождено
+    };
+
+    inline AllocationCounters &GetAllocationCounters()
+    {
+        static AllocationCounters counters;
+        return counters;
+    }
+
+    inline size_t GetAllocationsCount()
+    {
+        return GetAllocationCounters().count.load(std::memory_order_relaxed);
+    }
+
+    inline size_t GetLiveBytes()
+    {
+        return GetAllocationCounters().live_bytes.load(std::memory_order_relaxed);
+    }
+
+    namespace detail
+    {
+        // Размер блока хранится перед ним; отступ сохраняет выравнивание malloc
+        constexpr size_t ALLOCATION_HEADER = alignof(std::max_align_t);
+
+        inline void *Allocate(size_t size) noexcept
+        {
+            void *block = std::malloc(size + ALLOCATION_HEADER);
+            if (!block)
+            {
+                return nullptr;
+            }
+            *static_cast<size_t *>(block) = size;
+            AllocationCounters &counters = GetAllocationCounters();
+            counters.count.fetch_add(1, std::memory_order_relaxed);
+            counters.live_bytes.fetch_add(size, std::memory_order_relaxed);
+            return static_cast<char *>(block) + ALLOCATION_HEADER;
+        }
+
+        inline void Deallocate(void *pointer) noexcept
+        {
+            if (!pointer)
+            {
+                return;
+            }
+            void *block = static_cast<char *>(pointer) - ALLOCATION_HEADER;
+            GetAllocationCounters().live_bytes.fetch_sub(*static_cast<size_t *>(block), std::memory_order_relaxed);
+            std::free(block);
+        }
+    }
+}
+
+void *operator new(size_t size)
+{
+    if (void *pointer = bench::detail::Allocate(size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return bench::detail::Allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return bench::detail::Allocate(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    bench::detail::Deallocate(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    bench::detail::Deallocate(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    bench::detail::Deallocate(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    bench::detail::Deallocate(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+    bench::detail::Deallocate(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    bench::detail::Deallocate(pointer);
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "../transport-catalogue/json.h"
+#include "../transport-catalogue/transport_router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace bench
+{
+    template <typename Func>
+    double MeasureSeconds(Func func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        func();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    inline double Median(std::vector<double> values)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const size_t middle = values.size() / 2;
+        return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+    }
+
+    // Медиана абсолютных отклонений от медианы: разброс, на который не влияют единичные выбросы
+    inline double MedianAbsoluteDeviation(const std::vector<double> &values)
+    {
+        const double median = Median(values);
+        std::vector<double> deviations;
+        deviations.reserve(values.size());
+        for (const double value : values)
+        {
+            deviations.push_back(std::abs(value - median));
+        }
+        return Median(std::move(deviations));
+    }
+
+    // Значение, которого не превышает доля share значений (share из [0, 1]), по ближайшему рангу
+    inline double Percentile(std::vector<double> values, double share)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const size_t rank = static_cast<size_t>(std::ceil(share * static_cast<double>(values.size())));
+        return values[std::min(values.size(), std::max<size_t>(1, rank)) - 1];
+    }
+
+    // Занятая процессом память по /proc/self/statm (Linux), в байтах
+    inline size_t GetResidentBytes()
+    {
+        std::ifstream statm("/proc/self/statm");
+        size_t size = 0;
+        size_t resident = 0;
+        statm >> size >> resident;
+        return resident * 4096;
+    }
+
+    inline double ToMegabytes(size_t bytes)
+    {
+        return static_cast<double>(bytes) / (1 << 20);
+    }
+
+    inline std::string GridStopName(size_t row, size_t column)
+    {
+        return "Stop " + std::to_string(row) + "-" + std::to_string(column);
+    }
+
+    // Квадратная сетка side x side: по каждой строке и каждому столбцу ходит некольцевой автобус
+    inline json::Array MakeGridBase(size_t side)
+    {
+        json::Array base;
+        for (size_t row = 0; row < side; ++row)
+        {
+            for (size_t column = 0; column < side; ++column)
+            {
+                json::Dict distances;
+                if (column + 1 < side)
+                {
+                    distances[GridStopName(row, column + 1)] = 600 + static_cast<int>((row * 7 + column * 13) % 500);
+                }
+                if (row + 1 < side)
+                {
+                    distances[GridStopName(row + 1, column)] = 700 + static_cast<int>((row * 11 + column * 5) % 500);
+                }
+                base.push_back(json::Dict{{"type", "Stop"s},
+                                          {"name", GridStopName(row, column)},
+                                          {"latitude", 55.5 + 0.005 * static_cast<double>(row)},
+                                          {"longitude", 37.5 + 0.008 * static_cast<double>(column)},
+                                          {"road_distances", std::move(distances)}});
+            }
+        }
+        for (size_t line = 0; line < side; ++line)
+        {
+            json::Array row_stops;
+            json::Array column_stops;
+            for (size_t i = 0; i < side; ++i)
+            {
+                row_stops.push_back(GridStopName(line, i));
+                column_stops.push_back(GridStopName(i, line));
+            }
+            base.push_back(json::Dict{{"type", "Bus"s}, {"name", "R" + std::to_string(line)}, {"stops", std::move(row_stops)}, {"is_roundtrip", false}});
+            base.push_back(json::Dict{{"type", "Bus"s}, {"name", "C" + std::to_string(line)}, {"stops", std::move(column_stops)}, {"is_roundtrip", false}});
+        }
+        return base;
+    }
+
+    inline json::Dict MakeRenderSettings()
+    {
+        return json::Dict{{"width", 1200.0}, {"height", 1200.0}, {"padding", 50.0}, {"line_width", 14.0}, {"stop_radius", 5.0}, {"bus_label_font_size", 20}, {"bus_label_offset", json::Array{7.0, 15.0}}, {"stop_label_font_size", 20}, {"stop_label_offset", json::Array{7.0, -3.0}}, {"underlayer_color", json::Array{255, 255, 255, 0.85}}, {"underlayer_width", 3.0}, {"color_palette", json::Array{"green"s, json::Array{255, 160, 0}, "red"s}}};
+    }
+
+    // Случайная смесь запросов Bus/Stop/Route (map_share задаёт долю Map) по сетке side x side
+    inline json::Array MakeGridStatRequests(size_t side, size_t count, unsigned seed, double map_share = 0.0)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution<size_t> coordinate(0, side - 1);
+        std::uniform_real_distribution<double> share(0.0, 1.0);
+        json::Array requests;
+        for (size_t id = 0; id < count; ++id)
+        {
+            const double kind = share(generator);
+            if (kind < map_share)
+            {
+                requests.push_back(json::Dict{{"id", static_cast<int>(id)}, {"type", "Map"s}});
+            }
+            else if (kind < map_share + 0.15)
+            {
+                requests.push_back(json::Dict{{"id", static_cast<int>(id)}, {"type", "Bus"s}, {"name", "R" + std::to_string(coordinate(generator))}});
+            }
+            else if (kind < map_share + 0.3)
+            {
+                requests.push_back(json::Dict{{"id", static_cast<int>(id)}, {"type", "Stop"s}, {"name", GridStopName(coordinate(generator), coordinate(generator))}});
+            }
+            else
+            {
+                requests.push_back(json::Dict{{"id", static_cast<int>(id)}, {"type", "Route"s}, {"from", GridStopName(coordinate(generator), coordinate(generator))}, {"to", GridStopName(coordinate(generator), coordinate(generator))}});
+            }
+        }
+        return requests;
+    }
+
+    // Настройки маршрутизатора бенчмарков: по умолчанию ожидание 6 минут и скорость 40 км/ч
+    inline router::RoutingSettings MakeRoutingSettings(router::RoutingEngine engine, int bus_wait_time = 6, int bus_velocity = 40)
+    {
+        router::RoutingSettings settings;
+        settings.bus_wait_time = bus_wait_time;
+        settings.bus_velocity = bus_velocity;
+        settings.engine = engine;
+        return settings;
+    }
+
+    // TransportRouter со временем построения в build_seconds
+    inline std::unique_ptr<router::TransportRouter> BuildRouter(const router::RoutingSettings &settings, guide::TransportCatalogue &catalogue, double &build_seconds)
+    {
+        std::unique_ptr<router::TransportRouter> transport_router;
+        build_seconds = MeasureSeconds([&]
+                                       { transport_router = std::make_unique<router::TransportRouter>(settings, catalogue); });
+        return transport_router;
+    }
+
+    // Время маршрута: ожидания и поездки
+    inline double GetTotalTime(const router::RouteItems &route)
+    {
+        double total_time = 0.0;
+        for (const auto &item : route)
+        {
+            total_time += std::holds_alternative<guide::RouteWaitInfo>(item) ? std::get<guide::RouteWaitInfo>(item).time : std::get<guide::RouteBusInfo>(item).time;
+        }
+        return total_time;
+    }
+}
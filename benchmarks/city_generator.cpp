@@ -0,0 +1,152 @@
+#include "city_generator.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    // Доли запросов вида "bus:2,stop:2,route:5,map:0.01,route_matrix:0.1,isochrone:0.5"
+    bench::RequestMix ParseRequestMix(const std::string &text)
+    {
+        bench::RequestMix mix{0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        std::istringstream input(text);
+        std::string item;
+        while (std::getline(input, item, ','))
+        {
+            const size_t colon = item.find(':');
+            if (colon == std::string::npos)
+            {
+                throw std::invalid_argument("Request mix item must be type:share: " + item);
+            }
+            const std::string type = item.substr(0, colon);
+            const double share = std::stod(item.substr(colon + 1));
+            if (type == "bus")
+            {
+                mix.bus = share;
+            }
+            else if (type == "stop")
+            {
+                mix.stop = share;
+            }
+            else if (type == "route")
+            {
+                mix.route = share;
+            }
+            else if (type == "map")
+            {
+                mix.map = share;
+            }
+            else if (type == "route_matrix")
+            {
+                mix.route_matrix = share;
+            }
+            else if (type == "isochrone")
+            {
+                mix.isochrone = share;
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown request type in mix: " + type);
+            }
+        }
+        return mix;
+    }
+}
+
+// Синтетический вход справочника в stdout. Ключи --name=value; --preset (1k, 10k, 100k) задаёт размеры,
+// остальные ключи переопределяют их:
+// city_generator [--preset=10k] [--seed=1] [--stops=1000] [--buses=100] [--min_route_stops=5] [--max_route_stops=30]
+//                [--round_share=0.3] [--road_distance_density=0.5] [--requests=1000] [--mix=bus:0.2,stop:0.2,route:0.6]
+//                [--unknown_share=0.01] [--matrix_side=10] [--bus_wait_time=6] [--bus_velocity=40] [--routing_engine=auto]
+int main(int argc, char *argv[])
+{
+    bench::CitySettings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg.substr(0, 9) == "--preset=")
+        {
+            settings = bench::MakeCityPreset(std::string(arg.substr(9)));
+        }
+    }
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        const size_t equals = arg.find('=');
+        if (arg.substr(0, 2) != "--" || equals == std::string_view::npos)
+        {
+            std::cerr << "error: expected --name=value, got " << arg << std::endl;
+            return 1;
+        }
+        const std::string name(arg.substr(2, equals - 2));
+        const std::string value(arg.substr(equals + 1));
+        if (name == "preset")
+        {
+            continue;
+        }
+        if (name == "seed")
+        {
+            settings.seed = std::stoull(value);
+        }
+        else if (name == "stops")
+        {
+            settings.stops_count = std::stoul(value);
+        }
+        else if (name == "buses")
+        {
+            settings.buses_count = std::stoul(value);
+        }
+        else if (name == "min_route_stops")
+        {
+            settings.min_route_stops = std::stoul(value);
+        }
+        else if (name == "max_route_stops")
+        {
+            settings.max_route_stops = std::stoul(value);
+        }
+        else if (name == "round_share")
+        {
+            settings.round_share = std::stod(value);
+        }
+        else if (name == "road_distance_density")
+        {
+            settings.road_distance_density = std::stod(value);
+        }
+        else if (name == "requests")
+        {
+            settings.requests_count = std::stoul(value);
+        }
+        else if (name == "mix")
+        {
+            settings.mix = ParseRequestMix(value);
+        }
+        else if (name == "unknown_share")
+        {
+            settings.unknown_share = std::stod(value);
+        }
+        else if (name == "matrix_side")
+        {
+            settings.matrix_side = std::stoul(value);
+        }
+        else if (name == "bus_wait_time")
+        {
+            settings.bus_wait_time = std::stoi(value);
+        }
+        else if (name == "bus_velocity")
+        {
+            settings.bus_velocity = std::stoi(value);
+        }
+        else if (name == "routing_engine")
+        {
+            settings.routing_engine = value;
+        }
+        else
+        {
+            std::cerr << "error: unknown option --" << name << std::endl;
+            return 1;
+        }
+    }
+    json::Print(json::Document(bench::MakeCity(settings)), std::cout);
+}
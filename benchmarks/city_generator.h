@@ -0,0 +1,351 @@
+#pragma once
+
+#include "bench_utils.h"
+#include "../transport-catalogue/geo.h"
+#include "../transport-catalogue/json.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+    // Доли типов запросов в stat_requests; нормируются на сумму
+    struct RequestMix
+    {
+        double bus = 0.2;
+        double stop = 0.2;
+        double route = 0.6;
+        double map = 0.0;
+        double route_matrix = 0.0;
+        double isochrone = 0.0;
+    };
+
+    struct CitySettings
+    {
+        uint64_t seed = 1;
+        size_t stops_count = 1000;
+        size_t buses_count = 100;
+        size_t min_route_stops = 5; // длина маршрута в остановках равномерна на [min, max]
+        size_t max_route_stops = 30;
+        double round_share = 0.3;           // доля кольцевых маршрутов
+        double road_distance_density = 0.5; // вероятность дорожного расстояния до соседней остановки вне маршрутов
+        size_t requests_count = 1000;
+        RequestMix mix;
+        double unknown_share = 0.01; // доля Bus/Stop/Route-запросов с неизвестным названием
+        size_t matrix_side = 10;     // остановок в from и to у RouteMatrix
+        int bus_wait_time = 6;
+        int bus_velocity = 40;
+        std::string routing_engine = "auto"; // пусто — ключ routing_engine не пишется
+    };
+
+    // Готовые размеры: "1k", "10k", "100k" остановок
+    inline CitySettings MakeCityPreset(const std::string &name)
+    {
+        CitySettings settings;
+        if (name == "1k")
+        {
+            settings.stops_count = 1000;
+            settings.buses_count = 150;
+        }
+        else if (name == "10k")
+        {
+            settings.stops_count = 10000;
+            settings.buses_count = 1200;
+            settings.max_route_stops = 50;
+        }
+        else if (name == "100k")
+        {
+            settings.stops_count = 100000;
+            settings.buses_count = 10000;
+            settings.max_route_stops = 80;
+        }
+        else
+        {
+            throw std::invalid_argument("Unknown city preset: " + name);
+        }
+        return settings;
+    }
+
+    // Случайные числа, одинаковые на всех платформах: распределения стандартной библиотеки
+    // зависят от реализации, поэтому числа берутся прямо из mt19937_64
+    class CityRandom
+    {
+    public:
+        explicit CityRandom(uint64_t seed)
+            : generator_(seed)
+        {
+        }
+
+        // Целое из [0, count)
+        size_t Index(size_t count)
+        {
+            return static_cast<size_t>(generator_() % count);
+        }
+
+        // Число из [0, 1)
+        double Real()
+        {
+            return static_cast<double>(generator_() >> 11) * 0x1.0p-53;
+        }
+
+        bool Chance(double probability)
+        {
+            return Real() < probability;
+        }
+
+    private:
+        std::mt19937_64 generator_;
+    };
+
+    inline std::string CityStopName(size_t stop)
+    {
+        return "Stop " + std::to_string(stop);
+    }
+
+    inline std::string CityBusName(size_t bus)
+    {
+        return "Bus " + std::to_string(bus);
+    }
+
+    // Синтетический город: остановки в ячейках квадратной сетки со случайным сдвигом, маршруты — случайные
+    // блуждания по соседним ячейкам от остановки прошлых маршрутов (кольцевые возвращаются к первой остановке).
+    // Stop-запросы спрашивают о любой остановке, остальные — об обслуживаемых автобусами. Дорожные расстояния —
+    // расстояние по прямой с запасом 10–50 %, в каждую сторону своё. Для соседних остановок маршрута расстояния
+    // заданы в обе стороны, поэтому справочник найдёт любое нужное. Один seed — один и тот же документ
+    inline json::Dict MakeCity(const CitySettings &settings)
+    {
+        if (settings.stops_count < 2 || settings.min_route_stops < 2 || settings.min_route_stops > settings.max_route_stops)
+        {
+            throw std::invalid_argument("City needs at least 2 stops and routes of at least 2 stops");
+        }
+        CityRandom random(settings.seed);
+        const size_t columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(settings.stops_count))));
+        // Координаты округлены до 1e-4 градуса: json::Print пишет 6 значащих цифр, и документ после печати не меняется
+        std::vector<guide::stop_coordinate::Coordinates> coordinates(settings.stops_count);
+        for (size_t stop = 0; stop < settings.stops_count; ++stop)
+        {
+            const double row = static_cast<double>(stop / columns) + 0.6 * (random.Real() - 0.5);
+            const double column = static_cast<double>(stop % columns) + 0.6 * (random.Real() - 0.5);
+            coordinates[stop] = {std::round((55.0 + 0.004 * row) * 1e4) / 1e4, std::round((37.0 + 0.006 * column) * 1e4) / 1e4};
+        }
+        auto neighbours = [&](size_t stop)
+        {
+            std::vector<size_t> result;
+            const size_t row = stop / columns;
+            const size_t column = stop % columns;
+            for (size_t r = row > 0 ? row - 1 : 0; r <= row + 1; ++r)
+            {
+                for (size_t c = column > 0 ? column - 1 : 0; c <= std::min(column + 1, columns - 1); ++c)
+                {
+                    const size_t other = r * columns + c;
+                    if (other != stop && other < settings.stops_count)
+                    {
+                        result.push_back(other);
+                    }
+                }
+            }
+            return result;
+        };
+        auto cell_distance = [&](size_t lhs, size_t rhs)
+        {
+            const size_t rows = lhs / columns > rhs / columns ? lhs / columns - rhs / columns : rhs / columns - lhs / columns;
+            const size_t cols = lhs % columns > rhs % columns ? lhs % columns - rhs % columns : rhs % columns - lhs % columns;
+            return std::max(rows, cols);
+        };
+
+        std::vector<std::map<size_t, int>> road_distances(settings.stops_count);
+        auto add_distance = [&](size_t from, size_t to)
+        {
+            if (!road_distances[from].count(to))
+            {
+                const double distance = guide::stop_coordinate::ComputeDistance(coordinates[from], coordinates[to]) * (1.1 + 0.4 * random.Real());
+                road_distances[from][to] = std::max(1, static_cast<int>(std::lround(distance)));
+            }
+        };
+
+        // Маршрут начинается на остановке прошлых маршрутов, поэтому сеть связна
+        std::vector<size_t> served;
+        std::vector<bool> is_served(settings.stops_count, false);
+        json::Array buses;
+        for (size_t bus = 0; bus < settings.buses_count; ++bus)
+        {
+            const size_t length = settings.min_route_stops + random.Index(settings.max_route_stops - settings.min_route_stops + 1);
+            const bool is_round = random.Chance(settings.round_share);
+            std::vector<size_t> route{served.empty() ? random.Index(settings.stops_count) : served[random.Index(served.size())]};
+            auto visited = [&route](size_t stop)
+            {
+                return std::find(route.begin(), route.end(), stop) != route.end();
+            };
+            // Кольцевой маршрут половину пути уходит от первой остановки и столько же возвращается
+            const size_t outbound = is_round ? std::max<size_t>(2, (length + 1) / 2) : length;
+            while (route.size() < outbound)
+            {
+                std::vector<size_t> options;
+                for (const size_t next : neighbours(route.back()))
+                {
+                    if (!visited(next))
+                    {
+                        options.push_back(next);
+                    }
+                }
+                if (options.empty())
+                {
+                    break;
+                }
+                route.push_back(options[random.Index(options.size())]);
+            }
+            if (route.size() < 2)
+            {
+                route.push_back(neighbours(route[0])[0]);
+            }
+            if (is_round)
+            {
+                while (cell_distance(route.back(), route[0]) > 1)
+                {
+                    std::vector<size_t> options;
+                    for (const size_t next : neighbours(route.back()))
+                    {
+                        if (!visited(next) && cell_distance(next, route[0]) < cell_distance(route.back(), route[0]))
+                        {
+                            options.push_back(next);
+                        }
+                    }
+                    if (options.empty())
+                    {
+                        break;
+                    }
+                    route.push_back(options[random.Index(options.size())]);
+                }
+                route.push_back(route[0]);
+            }
+            json::Array stops;
+            for (size_t i = 0; i < route.size(); ++i)
+            {
+                if (i > 0)
+                {
+                    add_distance(route[i - 1], route[i]);
+                    add_distance(route[i], route[i - 1]);
+                }
+                stops.push_back(CityStopName(route[i]));
+                if (!is_served[route[i]])
+                {
+                    is_served[route[i]] = true;
+                    served.push_back(route[i]);
+                }
+            }
+            buses.push_back(json::Dict{{"type", "Bus"s}, {"name", CityBusName(bus)}, {"stops", std::move(stops)}, {"is_roundtrip", is_round}});
+        }
+        for (size_t stop = 0; stop < settings.stops_count; ++stop)
+        {
+            for (const size_t next : neighbours(stop))
+            {
+                if (random.Chance(settings.road_distance_density))
+                {
+                    add_distance(stop, next);
+                }
+            }
+        }
+
+        json::Array base;
+        base.reserve(settings.stops_count + buses.size());
+        for (size_t stop = 0; stop < settings.stops_count; ++stop)
+        {
+            json::Dict distances;
+            for (const auto &[to, distance] : road_distances[stop])
+            {
+                distances[CityStopName(to)] = distance;
+            }
+            base.push_back(json::Dict{{"type", "Stop"s},
+                                      {"name", CityStopName(stop)},
+                                      {"latitude", coordinates[stop].lat},
+                                      {"longitude", coordinates[stop].lng},
+                                      {"road_distances", std::move(distances)}});
+        }
+        for (auto &bus : buses)
+        {
+            base.push_back(std::move(bus));
+        }
+
+        const RequestMix &mix = settings.mix;
+        const double mix_total = mix.bus + mix.stop + mix.route + mix.map + mix.route_matrix + mix.isochrone;
+        if (!(mix_total > 0.0))
+        {
+            throw std::invalid_argument("Request mix must have a positive share");
+        }
+        // Концы маршрутов — остановки, через которые ходят автобусы
+        auto served_stop = [&]
+        {
+            return served.empty() ? random.Index(settings.stops_count) : served[random.Index(served.size())];
+        };
+        auto stop_name = [&]
+        {
+            return random.Chance(settings.unknown_share) ? "Unknown stop"s : CityStopName(served_stop());
+        };
+        auto stop_names = [&]
+        {
+            json::Array names;
+            for (size_t i = 0; i < settings.matrix_side; ++i)
+            {
+                names.push_back(CityStopName(served_stop()));
+            }
+            return names;
+        };
+        json::Array requests;
+        requests.reserve(settings.requests_count);
+        for (size_t id = 0; id < settings.requests_count; ++id)
+        {
+            json::Dict request{{"id", static_cast<int>(id)}};
+            double kind = random.Real() * mix_total;
+            if ((kind -= mix.bus) < 0.0)
+            {
+                request["type"] = "Bus"s;
+                request["name"] = random.Chance(settings.unknown_share) || settings.buses_count == 0 ? "Unknown bus"s : CityBusName(random.Index(settings.buses_count));
+            }
+            else if ((kind -= mix.stop) < 0.0)
+            {
+                request["type"] = "Stop"s;
+                request["name"] = random.Chance(settings.unknown_share) ? "Unknown stop"s : CityStopName(random.Index(settings.stops_count));
+            }
+            else if ((kind -= mix.route) < 0.0)
+            {
+                request["type"] = "Route"s;
+                request["from"] = stop_name();
+                request["to"] = stop_name();
+            }
+            else if ((kind -= mix.map) < 0.0)
+            {
+                request["type"] = "Map"s;
+            }
+            else if ((kind -= mix.route_matrix) < 0.0)
+            {
+                request["type"] = "RouteMatrix"s;
+                request["from"] = stop_names();
+                request["to"] = stop_names();
+            }
+            else
+            {
+                request["type"] = "Isochrone"s;
+                request["from"] = CityStopName(served_stop());
+                request["max_time"] = static_cast<int>(5 + random.Index(56));
+            }
+            requests.push_back(std::move(request));
+        }
+
+        json::Dict routing_settings{{"bus_wait_time", settings.bus_wait_time}, {"bus_velocity", settings.bus_velocity}};
+        if (!settings.routing_engine.empty())
+        {
+            routing_settings["routing_engine"] = settings.routing_engine;
+        }
+        return json::Dict{{"base_requests", std::move(base)},
+                          {"render_settings", MakeRenderSettings()},
+                          {"routing_settings", std::move(routing_settings)},
+                          {"stat_requests", std::move(requests)}};
+    }
+}
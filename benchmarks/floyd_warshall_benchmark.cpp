@@ -0,0 +1,133 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/router.h"
+#include "../transport-catalogue/parallel.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Разреженный граф, похожий на транспортный: цепочки рёбер вдоль «линий» и случайные пересадки
+    graph::DirectedWeightedGraph<double> MakeTransitGraph(size_t vertex_count, unsigned seed)
+    {
+        graph::DirectedWeightedGraph<double> graph(vertex_count);
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution<size_t> vertex(0, vertex_count - 1);
+        std::uniform_real_distribution<double> weight(1.0, 10.0);
+        for (size_t from = 0; from + 1 < vertex_count; ++from)
+        {
+            graph.AddEdge({from, from + 1, weight(generator)});
+            graph.AddEdge({from + 1, from, weight(generator)});
+        }
+        for (size_t i = 0; i < 3 * vertex_count; ++i)
+        {
+            graph.AddEdge({vertex(generator), vertex(generator), weight(generator)});
+        }
+        return graph;
+    }
+
+    // Веса таблиц совпадают, а восстановленные пути — цепочки рёбер нужного веса
+    bool CheckSame(const graph::DirectedWeightedGraph<double> &graph, const graph::Router<double> &expected, const graph::Router<double> &actual)
+    {
+        const size_t vertex_count = graph.GetVertexCount();
+        for (graph::VertexId from = 0; from < vertex_count; ++from)
+        {
+            for (graph::VertexId to = 0; to < vertex_count; ++to)
+            {
+                const auto expected_weight = expected.GetRouteWeight(from, to);
+                const auto actual_weight = actual.GetRouteWeight(from, to);
+                if (expected_weight.has_value() != actual_weight.has_value() || (expected_weight && std::abs(*expected_weight - *actual_weight) > 1e-9 * (1.0 + *expected_weight)))
+                {
+                    return false;
+                }
+            }
+        }
+        std::mt19937 generator(1);
+        std::uniform_int_distribution<size_t> vertex(0, vertex_count - 1);
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            const graph::VertexId from = vertex(generator);
+            const graph::VertexId to = vertex(generator);
+            const auto route = actual.BuildRoute(from, to);
+            if (!route)
+            {
+                continue;
+            }
+            double weight = 0.0;
+            graph::VertexId current = from;
+            for (const graph::EdgeId edge_id : route->edges)
+            {
+                const auto &edge = graph.GetEdge(edge_id);
+                if (edge.from != current)
+                {
+                    return false;
+                }
+                weight += edge.weight;
+                current = edge.to;
+            }
+            if (current != to || std::abs(weight - route->weight) > 1e-9 * (1.0 + weight))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<size_t> ParseSizes(const std::string &text)
+    {
+        std::vector<size_t> sizes;
+        std::istringstream input(text);
+        for (std::string size; std::getline(input, size, ',');)
+        {
+            sizes.push_back(std::stoul(size));
+        }
+        return sizes;
+    }
+}
+
+// Предподсчёт graph::Router: классический тройной цикл против блочного ядра.
+// Запуск: floyd_warshall_benchmark [размеры через запятую] [потоки] [повторы]
+int main(int argc, char *argv[])
+{
+    const std::vector<size_t> sizes = ParseSizes(argc > 1 ? argv[1] : "1000,2000,4000");
+    const size_t threads_count = argc > 2 ? std::stoul(argv[2]) : parallel::DefaultThreadsCount();
+    const size_t repeats = argc > 3 ? std::stoul(argv[3]) : 1;
+
+    std::cout << "vertices\tclassic_s\tblocked_1_thread_s\tblocked_" << threads_count << "_threads_s\tspeedup" << std::endl;
+    for (const size_t vertex_count : sizes)
+    {
+        const auto graph = MakeTransitGraph(vertex_count, 42);
+        std::vector<double> classic_times;
+        std::vector<double> blocked_times;
+        std::vector<double> parallel_times;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            std::optional<graph::Router<double>> classic;
+            std::optional<graph::Router<double>> blocked;
+            classic_times.push_back(bench::MeasureSeconds([&]
+                                                          { classic.emplace(graph); }));
+            blocked_times.push_back(bench::MeasureSeconds([&]
+                                                          { blocked.emplace(graph, graph::RoutesPrecomputation::BLOCKED, 1); }));
+            if (!CheckSame(graph, *classic, *blocked))
+            {
+                std::cerr << "blocked table differs from classic for " << vertex_count << " vertices" << std::endl;
+                return 1;
+            }
+            blocked.reset();
+            parallel_times.push_back(bench::MeasureSeconds([&]
+                                                           { blocked.emplace(graph, graph::RoutesPrecomputation::BLOCKED, threads_count); }));
+            if (!CheckSame(graph, *classic, *blocked))
+            {
+                std::cerr << "parallel blocked table differs from classic for " << vertex_count << " vertices" << std::endl;
+                return 1;
+            }
+        }
+        const double classic_time = bench::Median(classic_times);
+        const double parallel_time = bench::Median(parallel_times);
+        std::cout << vertex_count << '\t' << classic_time << '\t' << bench::Median(blocked_times) << '\t' << parallel_time << '\t' << classic_time / parallel_time << std::endl;
+    }
+}
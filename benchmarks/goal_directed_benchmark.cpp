@@ -0,0 +1,86 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Поиск одиночных маршрутов до цели (двунаправленный, A*, ALT) против поиска Дейкстры: просмотренные вершины и время запроса.
+// Запуск: goal_directed_benchmark [сторона сетки] [число запросов] [повторы] [опорных вершин ALT]
+int main(int argc, char *argv[])
+{
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 40;
+    const size_t queries_count = argc > 2 ? std::stoul(argv[2]) : 2000;
+    const size_t repeats = argc > 3 ? std::stoul(argv[3]) : 3;
+    const size_t landmarks_count = argc > 4 ? std::stoul(argv[4]) : 16;
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(bench::MakeGridBase(side), catalogue);
+    const size_t stops_count = side * side;
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<size_t> stop(0, stops_count - 1);
+    std::vector<std::pair<size_t, size_t>> queries(queries_count);
+    for (auto &[from, to] : queries)
+    {
+        from = stop(generator);
+        to = stop(generator);
+    }
+
+    std::cout << "stops: " << stops_count << ", queries: " << queries_count << ", repeats: " << repeats << ", landmarks: " << landmarks_count << std::endl;
+    std::cout << "engine\tpreprocessing_s\tper_query_us\tsettled_avg\tsettled_share\trelaxed_avg\tspeedup" << std::endl;
+
+    std::vector<std::optional<double>> reference_times;
+    double reference_settled = 0.0;
+    double reference_seconds = 0.0;
+    for (const auto engine : {router::RoutingEngine::DIJKSTRA, router::RoutingEngine::BIDIRECTIONAL, router::RoutingEngine::ASTAR, router::RoutingEngine::ALT})
+    {
+        router::RoutingSettings settings = bench::MakeRoutingSettings(engine);
+        settings.landmarks_count = landmarks_count;
+        double preprocessing = 0.0;
+        const auto transport_router = bench::BuildRouter(settings, catalogue, preprocessing);
+        auto search = transport_router->CreateSearch();
+
+        std::vector<std::optional<double>> total_times(queries.size());
+        size_t settled = 0;
+        size_t relaxed = 0;
+        std::vector<double> times;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            settled = 0;
+            relaxed = 0;
+            times.push_back(bench::MeasureSeconds([&]
+                                                  {
+                for (size_t index = 0; index < queries.size(); ++index)
+                {
+                    const auto route = transport_router->GetRouteInfo(queries[index].first, queries[index].second, search);
+                    settled += search.GetStats().settled_vertices;
+                    relaxed += search.GetStats().relaxed_edges;
+                    total_times[index] = route ? std::optional<double>(bench::GetTotalTime(*route)) : std::nullopt;
+                } }));
+        }
+
+        const double settled_avg = static_cast<double>(settled) / static_cast<double>(queries.size());
+        const double seconds = bench::Median(times);
+        if (engine == router::RoutingEngine::DIJKSTRA)
+        {
+            reference_times = total_times;
+            reference_settled = settled_avg;
+            reference_seconds = seconds;
+        }
+        for (size_t index = 0; index < queries.size(); ++index)
+        {
+            if (total_times[index].has_value() != reference_times[index].has_value() || (total_times[index] && std::abs(*total_times[index] - *reference_times[index]) > 1e-6))
+            {
+                std::cerr << "error: " << router::GetEngineName(engine) << " total_time differs from dijkstra for query " << index << std::endl;
+                return 1;
+            }
+        }
+        std::cout << router::GetEngineName(engine) << '\t' << preprocessing << '\t' << seconds / static_cast<double>(queries.size()) * 1e6 << '\t'
+                  << settled_avg << '\t' << settled_avg / reference_settled << '\t' << static_cast<double>(relaxed) / static_cast<double>(queries.size()) << '\t'
+                  << reference_seconds / seconds << std::endl;
+    }
+}
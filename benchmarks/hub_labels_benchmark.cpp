@@ -0,0 +1,100 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Метки хабов против таблицы всех пар и поиска Дейкстры: построение, размеры меток, сохранение и загрузка,
+// время запроса только времени в пути (RouteMatrix) и маршрута целиком (Route).
+// Запуск: hub_labels_benchmark [сторона сетки] [размер стороны матрицы] [повторы]
+int main(int argc, char *argv[])
+{
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 30;
+    const size_t matrix_side = argc > 2 ? std::stoul(argv[2]) : 100;
+    const size_t repeats = argc > 3 ? std::stoul(argv[3]) : 3;
+    const std::string labels_file = "hub_labels_benchmark.bin";
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(bench::MakeGridBase(side), catalogue);
+    const size_t stops_count = side * side;
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<size_t> stop(0, stops_count - 1);
+    std::vector<size_t> origins(matrix_side);
+    std::vector<size_t> destinations(matrix_side);
+    for (size_t i = 0; i < matrix_side; ++i)
+    {
+        origins[i] = stop(generator);
+        destinations[i] = stop(generator);
+    }
+    const double pairs = static_cast<double>(matrix_side * matrix_side);
+
+    std::cout << "stops: " << stops_count << ", pairs: " << matrix_side * matrix_side << ", repeats: " << repeats << std::endl;
+    std::cout << "engine\tpreprocessing_s\tdistance_us\troute_us" << std::endl;
+
+    std::vector<std::vector<std::optional<double>>> reference;
+    for (const auto engine : {router::RoutingEngine::DIJKSTRA, router::RoutingEngine::ALL_PAIRS_BLOCKED, router::RoutingEngine::HUB_LABELS})
+    {
+        const router::RoutingSettings settings = bench::MakeRoutingSettings(engine);
+        double preprocessing = 0.0;
+        const auto transport_router = bench::BuildRouter(settings, catalogue, preprocessing);
+        auto search = transport_router->CreateSearch();
+
+        std::vector<std::vector<std::optional<double>>> total_times;
+        std::vector<double> distance_times;
+        std::vector<double> route_times;
+        size_t checksum = 0;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            distance_times.push_back(bench::MeasureSeconds([&]
+                                                           { total_times = transport_router->GetTotalTimes(origins, destinations, 1); }));
+            route_times.push_back(bench::MeasureSeconds([&]
+                                                        {
+                for (const size_t from : origins)
+                {
+                    for (const size_t to : destinations)
+                    {
+                        const auto route = transport_router->GetRouteInfo(from, to, search);
+                        checksum += route ? route->size() : 0;
+                    }
+                } }));
+        }
+        if (reference.empty())
+        {
+            reference = total_times;
+        }
+        for (size_t row = 0; row < matrix_side; ++row)
+        {
+            for (size_t column = 0; column < matrix_side; ++column)
+            {
+                const auto &time = total_times[row][column];
+                const auto &expected = reference[row][column];
+                if (time.has_value() != expected.has_value() || (time && std::abs(*time - *expected) > 1e-6))
+                {
+                    std::cerr << "error: " << router::GetEngineName(engine) << " total_time differs from dijkstra" << std::endl;
+                    return 1;
+                }
+            }
+        }
+        std::cout << router::GetEngineName(engine) << '\t' << preprocessing << '\t' << bench::Median(distance_times) / pairs * 1e6 << '\t'
+                  << bench::Median(route_times) / pairs * 1e6 << std::endl;
+    }
+
+    // Сохранение и загрузка меток: первый запуск строит и пишет файл, второй читает его
+    std::remove(labels_file.c_str());
+    router::RoutingSettings settings = bench::MakeRoutingSettings(router::RoutingEngine::HUB_LABELS);
+    settings.hub_labels_file = labels_file;
+    const double build_and_save = bench::MeasureSeconds([&]
+                                                        { router::TransportRouter transport_router(settings, catalogue); });
+    const double load = bench::MeasureSeconds([&]
+                                              { router::TransportRouter transport_router(settings, catalogue); });
+    std::ifstream file(labels_file, std::ios::binary | std::ios::ate);
+    std::cout << "labels file: " << static_cast<double>(file.tellg()) / (1 << 20) << " MB, build and save: " << build_and_save << " s, load: " << load << " s" << std::endl;
+    std::remove(labels_file.c_str());
+}
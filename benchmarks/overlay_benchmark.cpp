@@ -0,0 +1,191 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::string CityStopName(size_t city_row, size_t city_column, size_t row, size_t column)
+    {
+        return "City " + std::to_string(city_row) + "-" + std::to_string(city_column) + " " + bench::GridStopName(row, column);
+    }
+
+    // Сетка cities_side x cities_side городов, каждый — сетка city_side x city_side с автобусами по строкам
+    // и столбцам. Центры соседних городов соединены междугородними автобусами
+    json::Array MakeMultiCityBase(size_t cities_side, size_t city_side)
+    {
+        json::Array base;
+        const size_t middle = city_side / 2;
+        for (size_t city_row = 0; city_row < cities_side; ++city_row)
+        {
+            for (size_t city_column = 0; city_column < cities_side; ++city_column)
+            {
+                for (size_t row = 0; row < city_side; ++row)
+                {
+                    for (size_t column = 0; column < city_side; ++column)
+                    {
+                        json::Dict distances;
+                        if (column + 1 < city_side)
+                        {
+                            distances[CityStopName(city_row, city_column, row, column + 1)] = 600 + static_cast<int>((row * 7 + column * 13) % 500);
+                        }
+                        if (row + 1 < city_side)
+                        {
+                            distances[CityStopName(city_row, city_column, row + 1, column)] = 700 + static_cast<int>((row * 11 + column * 5) % 500);
+                        }
+                        if (row == middle && column == middle)
+                        {
+                            if (city_column + 1 < cities_side)
+                            {
+                                distances[CityStopName(city_row, city_column + 1, middle, middle)] = 40000 + static_cast<int>((city_row * 3 + city_column * 7) % 10) * 1000;
+                            }
+                            if (city_row + 1 < cities_side)
+                            {
+                                distances[CityStopName(city_row + 1, city_column, middle, middle)] = 40000 + static_cast<int>((city_row * 5 + city_column * 3) % 10) * 1000;
+                            }
+                        }
+                        base.push_back(json::Dict{{"type", "Stop"s},
+                                                  {"name", CityStopName(city_row, city_column, row, column)},
+                                                  {"latitude", 50.0 + 0.5 * static_cast<double>(city_row) + 0.005 * static_cast<double>(row)},
+                                                  {"longitude", 30.0 + 0.8 * static_cast<double>(city_column) + 0.008 * static_cast<double>(column)},
+                                                  {"road_distances", std::move(distances)}});
+                    }
+                }
+                const std::string city = std::to_string(city_row) + "-" + std::to_string(city_column);
+                for (size_t line = 0; line < city_side; ++line)
+                {
+                    json::Array row_stops;
+                    json::Array column_stops;
+                    for (size_t i = 0; i < city_side; ++i)
+                    {
+                        row_stops.push_back(CityStopName(city_row, city_column, line, i));
+                        column_stops.push_back(CityStopName(city_row, city_column, i, line));
+                    }
+                    base.push_back(json::Dict{{"type", "Bus"s}, {"name", city + " R" + std::to_string(line)}, {"stops", std::move(row_stops)}, {"is_roundtrip", false}});
+                    base.push_back(json::Dict{{"type", "Bus"s}, {"name", city + " C" + std::to_string(line)}, {"stops", std::move(column_stops)}, {"is_roundtrip", false}});
+                }
+                if (city_column + 1 < cities_side)
+                {
+                    base.push_back(json::Dict{{"type", "Bus"s}, {"name", city + " E"}, {"stops", json::Array{CityStopName(city_row, city_column, middle, middle), CityStopName(city_row, city_column + 1, middle, middle)}}, {"is_roundtrip", false}});
+                }
+                if (city_row + 1 < cities_side)
+                {
+                    base.push_back(json::Dict{{"type", "Bus"s}, {"name", city + " S"}, {"stops", json::Array{CityStopName(city_row, city_column, middle, middle), CityStopName(city_row + 1, city_column, middle, middle)}}, {"is_roundtrip", false}});
+                }
+            }
+        }
+        return base;
+    }
+}
+
+// Оверлей против поиска Дейкстры на сети из нескольких городов: подготовка, время Route-запроса,
+// смена скорости автобусов (только пересчёт клик) против полного построения.
+// Запуск: overlay_benchmark [городов по стороне] [сторона города] [число запросов] [повторы] [остановок в ячейке] [уровней]
+int main(int argc, char *argv[])
+{
+    const size_t cities_side = argc > 1 ? std::stoul(argv[1]) : 6;
+    const size_t city_side = argc > 2 ? std::stoul(argv[2]) : 16;
+    const size_t queries_count = argc > 3 ? std::stoul(argv[3]) : 500;
+    const size_t repeats = argc > 4 ? std::stoul(argv[4]) : 3;
+    const size_t cell_size = argc > 5 ? std::stoul(argv[5]) : router::RoutingSettings{}.overlay_cell_size;
+    const size_t levels = argc > 6 ? std::stoul(argv[6]) : router::RoutingSettings{}.overlay_levels;
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(MakeMultiCityBase(cities_side, city_side), catalogue);
+    const size_t stops_count = cities_side * cities_side * city_side * city_side;
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<size_t> stop(0, stops_count - 1);
+    std::vector<std::pair<size_t, size_t>> queries(queries_count);
+    for (auto &[from, to] : queries)
+    {
+        from = stop(generator);
+        to = stop(generator);
+    }
+
+    std::cout << "stops: " << stops_count << ", queries: " << queries_count << ", repeats: " << repeats << ", cell size: " << cell_size << ", levels: " << levels << std::endl;
+    std::cout << "engine\tpreprocessing_s\tper_query_us\tsettled_avg\tspeedup" << std::endl;
+
+    auto run_queries = [&](const router::TransportRouter &transport_router, std::vector<std::optional<double>> &total_times, size_t &settled)
+    {
+        auto search = transport_router.CreateSearch();
+        std::vector<double> times;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            settled = 0;
+            times.push_back(bench::MeasureSeconds([&]
+                                                  {
+                for (size_t index = 0; index < queries.size(); ++index)
+                {
+                    const auto route = transport_router.GetRouteInfo(queries[index].first, queries[index].second, search);
+                    settled += search.GetStats().settled_vertices;
+                    total_times[index] = route ? std::optional<double>(bench::GetTotalTime(*route)) : std::nullopt;
+                } }));
+        }
+        return bench::Median(times);
+    };
+    auto check = [&](const std::vector<std::optional<double>> &total_times, const std::vector<std::optional<double>> &expected, std::string_view name)
+    {
+        for (size_t index = 0; index < queries.size(); ++index)
+        {
+            if (total_times[index].has_value() != expected[index].has_value() || (total_times[index] && std::abs(*total_times[index] - *expected[index]) > 1e-6))
+            {
+                std::cerr << "error: " << name << " total_time differs from dijkstra for query " << index << std::endl;
+                return false;
+            }
+        }
+        return true;
+    };
+
+    std::vector<std::optional<double>> reference_times;
+    double reference_seconds = 0.0;
+    std::unique_ptr<router::TransportRouter> overlay_router;
+    for (const auto engine : {router::RoutingEngine::DIJKSTRA, router::RoutingEngine::BIDIRECTIONAL, router::RoutingEngine::OVERLAY})
+    {
+        router::RoutingSettings settings = bench::MakeRoutingSettings(engine);
+        settings.overlay_cell_size = cell_size;
+        settings.overlay_levels = levels;
+        double preprocessing = 0.0;
+        auto transport_router = bench::BuildRouter(settings, catalogue, preprocessing);
+        std::vector<std::optional<double>> total_times(queries.size());
+        size_t settled = 0;
+        const double seconds = run_queries(*transport_router, total_times, settled);
+        if (engine == router::RoutingEngine::DIJKSTRA)
+        {
+            reference_times = total_times;
+            reference_seconds = seconds;
+        }
+        if (!check(total_times, reference_times, router::GetEngineName(engine)))
+        {
+            return 1;
+        }
+        std::cout << router::GetEngineName(engine) << '\t' << preprocessing << '\t' << seconds / static_cast<double>(queries.size()) * 1e6 << '\t'
+                  << static_cast<double>(settled) / static_cast<double>(queries.size()) << '\t' << reference_seconds / seconds << std::endl;
+        if (engine == router::RoutingEngine::OVERLAY)
+        {
+            overlay_router = std::move(transport_router);
+        }
+    }
+
+    // Смена метрики: оверлею достаточно пересчитать клики, ответы сверяются с новым поиском Дейкстры
+    const int new_velocity = 30;
+    const double customization = bench::MeasureSeconds([&]
+                                                       { overlay_router->SetRoutingParameters(6, new_velocity, catalogue); });
+    const router::RoutingSettings dijkstra_settings = bench::MakeRoutingSettings(router::RoutingEngine::DIJKSTRA, 6, new_velocity);
+    const router::TransportRouter dijkstra_router(dijkstra_settings, catalogue);
+    std::vector<std::optional<double>> expected(queries.size());
+    std::vector<std::optional<double>> total_times(queries.size());
+    size_t settled = 0;
+    run_queries(dijkstra_router, expected, settled);
+    run_queries(*overlay_router, total_times, settled);
+    if (!check(total_times, expected, "overlay after bus_velocity change"))
+    {
+        return 1;
+    }
+    std::cout << "bus_velocity change: customization " << customization << " s" << std::endl;
+}
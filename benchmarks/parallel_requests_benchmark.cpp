@@ -0,0 +1,68 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/json_reader.h"
+#include "../transport-catalogue/parallel.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Масштабирование обработки stat_requests по числу потоков.
+// Запуск: parallel_requests_benchmark [сторона сетки] [число запросов] [повторы] [максимум потоков]
+int main(int argc, char *argv[])
+{
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 20;
+    const size_t requests_count = argc > 2 ? std::stoul(argv[2]) : 20000;
+    const size_t repeats = argc > 3 ? std::stoul(argv[3]) : 5;
+    const size_t max_threads = argc > 4 ? std::stoul(argv[4]) : parallel::DefaultThreadsCount();
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(bench::MakeGridBase(side), catalogue);
+    map_renderer::MapRenderer renderer;
+    guide::SetRenderSettings(bench::MakeRenderSettings(), renderer);
+    const router::RoutingSettings settings = bench::MakeRoutingSettings(router::RoutingEngine::ALL_PAIRS);
+    router::TransportRouter transport_router(settings, catalogue);
+    guide::RequestHandler handler(catalogue, renderer, transport_router);
+    const auto requests = guide::ParseStatRequests(bench::MakeGridStatRequests(side, requests_count, 42, 0.001), catalogue, transport_router);
+
+    std::cout << "stops: " << side * side << ", requests: " << requests.size() << ", repeats: " << repeats << std::endl;
+    std::cout << "threads\tmedian_s\tspeedup\tefficiency" << std::endl;
+
+    std::string reference;
+    double single_thread_time = 0.0;
+    std::vector<size_t> threads_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2)
+    {
+        threads_counts.push_back(threads);
+    }
+    threads_counts.push_back(max_threads);
+
+    for (const size_t threads : threads_counts)
+    {
+        std::vector<double> times;
+        json::Array answers;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            times.push_back(bench::MeasureSeconds([&]
+                                                  { answers = guide::FormRequestsAnswers(requests, handler, threads); }));
+        }
+        std::ostringstream printed;
+        json::Print(json::Document(answers), printed);
+        if (threads == 1)
+        {
+            reference = printed.str();
+        }
+        else if (printed.str() != reference)
+        {
+            std::cerr << "answers differ from single-threaded run for " << threads << " threads" << std::endl;
+            return 1;
+        }
+
+        const double median = bench::Median(times);
+        if (threads == 1)
+        {
+            single_thread_time = median;
+        }
+        const double speedup = single_thread_time / median;
+        std::cout << threads << '\t' << median << '\t' << speedup << '\t' << speedup / static_cast<double>(threads) << std::endl;
+    }
+}
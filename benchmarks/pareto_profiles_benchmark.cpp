@@ -0,0 +1,79 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Смена bus_wait_time и bus_velocity: таблица всех пар считается заново для каждой пары параметров,
+// Парето-профили строятся один раз, а параметры меняются через SetRoutingParameters.
+// Ответы при каждой паре параметров сверяются с таблицей всех пар.
+// Запуск: pareto_profiles_benchmark [сторона сетки] [пар параметров] [сторона матрицы]
+int main(int argc, char *argv[])
+{
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 20;
+    const size_t settings_count = argc > 2 ? std::stoul(argv[2]) : 5;
+    const size_t matrix_side = argc > 3 ? std::stoul(argv[3]) : 100;
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(bench::MakeGridBase(side), catalogue);
+    const size_t stops_count = side * side;
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<size_t> stop(0, stops_count - 1);
+    std::vector<size_t> origins(matrix_side);
+    std::vector<size_t> destinations(matrix_side);
+    for (size_t i = 0; i < matrix_side; ++i)
+    {
+        origins[i] = stop(generator);
+        destinations[i] = stop(generator);
+    }
+    std::uniform_int_distribution<int> wait_time(0, 30);
+    std::uniform_int_distribution<int> velocity(5, 120);
+    std::vector<std::pair<int, int>> parameters(settings_count);
+    for (auto &[bus_wait_time, bus_velocity] : parameters)
+    {
+        bus_wait_time = wait_time(generator);
+        bus_velocity = velocity(generator);
+    }
+
+    std::cout << "stops: " << stops_count << ", parameter sets: " << settings_count << ", pairs: " << matrix_side * matrix_side << std::endl;
+    const router::RoutingSettings profiles_settings = bench::MakeRoutingSettings(router::RoutingEngine::PARETO_PROFILES, parameters[0].first, parameters[0].second);
+    double build = 0.0;
+    const auto profiles = bench::BuildRouter(profiles_settings, catalogue, build);
+    std::cout << "pareto_profiles build: " << build << " s" << std::endl;
+    std::cout << "bus_wait_time\tbus_velocity\tall_pairs_s\tpareto_change_s\tall_pairs_matrix_us\tpareto_matrix_us" << std::endl;
+
+    for (const auto &[bus_wait_time, bus_velocity] : parameters)
+    {
+        const router::RoutingSettings table_settings = bench::MakeRoutingSettings(router::RoutingEngine::ALL_PAIRS, bus_wait_time, bus_velocity);
+        double table_build = 0.0;
+        const auto table = bench::BuildRouter(table_settings, catalogue, table_build);
+        const double change = bench::MeasureSeconds([&]
+                                                    { profiles->SetRoutingParameters(bus_wait_time, bus_velocity, catalogue); });
+        std::vector<std::vector<std::optional<double>>> expected;
+        std::vector<std::vector<std::optional<double>>> total_times;
+        const double table_matrix = bench::MeasureSeconds([&]
+                                                          { expected = table->GetTotalTimes(origins, destinations, 1); });
+        const double profiles_matrix = bench::MeasureSeconds([&]
+                                                             { total_times = profiles->GetTotalTimes(origins, destinations, 1); });
+        for (size_t row = 0; row < matrix_side; ++row)
+        {
+            for (size_t column = 0; column < matrix_side; ++column)
+            {
+                const auto &time = total_times[row][column];
+                const auto &expected_time = expected[row][column];
+                if (time.has_value() != expected_time.has_value() || (time && std::abs(*time - *expected_time) > 1e-6))
+                {
+                    std::cerr << "error: pareto_profiles total_time differs from all_pairs for bus_wait_time " << bus_wait_time << ", bus_velocity " << bus_velocity << std::endl;
+                    return 1;
+                }
+            }
+        }
+        const double pairs = static_cast<double>(matrix_side * matrix_side);
+        std::cout << bus_wait_time << '\t' << bus_velocity << '\t' << table_build << '\t' << change << '\t' << table_matrix / pairs * 1e6 << '\t' << profiles_matrix / pairs * 1e6 << std::endl;
+    }
+}
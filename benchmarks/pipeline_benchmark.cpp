@@ -0,0 +1,208 @@
+#include "city_generator.h"
+#include "../transport-catalogue/json_builder.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct PhaseResult
+    {
+        std::string phase;
+        double median_s;
+        double min_s;
+        double max_s;
+    };
+
+    struct SizeResult
+    {
+        size_t stops_count;
+        size_t buses_count;
+        size_t requests_count;
+        std::vector<PhaseResult> phases;
+    };
+
+    std::vector<size_t> ParseSizes(const std::string &text)
+    {
+        std::vector<size_t> sizes;
+        std::istringstream input(text);
+        std::string item;
+        while (std::getline(input, item, ','))
+        {
+            sizes.push_back(std::stoul(item));
+        }
+        return sizes;
+    }
+
+    // Один прогон конвейера main.cpp по тексту входа: время каждой фазы в порядке выполнения
+    std::vector<std::pair<std::string, double>> RunPipeline(const std::string &input_text, size_t threads_count)
+    {
+        std::vector<std::pair<std::string, double>> times;
+        json::Document document(nullptr);
+        times.emplace_back("json_load", bench::MeasureSeconds([&]
+                                                              {
+            std::istringstream input(input_text);
+            document = json::Load(input); }));
+        const json::Dict &root = document.GetRoot().AsMap();
+
+        guide::TransportCatalogue catalogue;
+        times.emplace_back("form_transport_base", bench::MeasureSeconds([&]
+                                                                        { guide::FormTransportBase(root.at("base_requests").AsArray(), catalogue); }));
+        map_renderer::MapRenderer renderer;
+        times.emplace_back("set_render_settings", bench::MeasureSeconds([&]
+                                                                        { guide::SetRenderSettings(root.at("render_settings").AsMap(), renderer); }));
+        std::unique_ptr<router::TransportRouter> transport_router;
+        times.emplace_back("transport_router", bench::MeasureSeconds([&]
+                                                                     { transport_router = std::make_unique<router::TransportRouter>(guide::ParseRoutingSettings(root.at("routing_settings").AsMap(), threads_count), catalogue); }));
+        std::vector<guide::StatRequest> requests;
+        times.emplace_back("parse_stat_requests", bench::MeasureSeconds([&]
+                                                                        { requests = guide::ParseStatRequests(root.at("stat_requests").AsArray(), catalogue, *transport_router); }));
+
+        // Запросы каждого типа отвечаются отдельным пакетом; ответы складываются в исходном порядке
+        guide::RequestHandler handler(catalogue, renderer, *transport_router);
+        std::map<guide::RequestType, std::vector<size_t>> indexes_by_type;
+        for (size_t index = 0; index < requests.size(); ++index)
+        {
+            indexes_by_type[requests[index].type].push_back(index);
+        }
+        json::Array answers(requests.size());
+        for (const auto &[type, indexes] : indexes_by_type)
+        {
+            std::vector<guide::StatRequest> batch;
+            batch.reserve(indexes.size());
+            for (const size_t index : indexes)
+            {
+                batch.push_back(requests[index]);
+            }
+            json::Array batch_answers;
+            times.emplace_back(guide::GetRequestTypeName(type), bench::MeasureSeconds([&]
+                                                                               { batch_answers = handler.FormAnswers(batch, threads_count); }));
+            for (size_t i = 0; i < indexes.size(); ++i)
+            {
+                answers[indexes[i]] = std::move(batch_answers[i]);
+            }
+        }
+
+        std::ostringstream output;
+        const json::Document answers_document(std::move(answers));
+        times.emplace_back("serialization", bench::MeasureSeconds([&]
+                                                                  { json::Print(answers_document, output); }));
+        double total = 0.0;
+        for (const auto &[phase, seconds] : times)
+        {
+            total += seconds;
+        }
+        times.emplace_back("total", total);
+        return times;
+    }
+
+    void WriteJson(std::ostream &output, const std::vector<SizeResult> &results, size_t repeats, size_t threads_count)
+    {
+        json::Builder builder;
+        builder.StartDict().Key("benchmark").Value("pipeline"s).Key("repeats").Value(static_cast<int>(repeats)).Key("threads").Value(static_cast<int>(threads_count));
+        builder.Key("results").StartArray();
+        for (const auto &result : results)
+        {
+            builder.StartDict().Key("stops").Value(static_cast<int>(result.stops_count)).Key("buses").Value(static_cast<int>(result.buses_count));
+            builder.Key("requests").Value(static_cast<int>(result.requests_count)).Key("phases").StartArray();
+            for (const auto &phase : result.phases)
+            {
+                builder.StartDict().Key("phase").Value(phase.phase).Key("median_s").Value(phase.median_s).Key("min_s").Value(phase.min_s).Key("max_s").Value(phase.max_s).EndDict();
+            }
+            builder.EndArray().EndDict();
+        }
+        builder.EndArray().EndDict();
+        json::Print(json::Document(builder.Build()), output);
+    }
+
+    void WriteCsv(std::ostream &output, const std::vector<SizeResult> &results)
+    {
+        output << "stops,buses,requests,phase,median_s,min_s,max_s\n";
+        for (const auto &result : results)
+        {
+            for (const auto &phase : result.phases)
+            {
+                output << result.stops_count << ',' << result.buses_count << ',' << result.requests_count << ',' << phase.phase << ','
+                       << phase.median_s << ',' << phase.min_s << ',' << phase.max_s << '\n';
+            }
+        }
+    }
+}
+
+// Конвейер main.cpp на синтетических городах растущего размера (bench::MakeCity): время разбора JSON,
+// FormTransportBase, SetRenderSettings, построения TransportRouter, разбора stat_requests, ответов на запросы
+// каждого типа и печати ответов. Каждый размер прогоняется repeats раз с нуля; печатаются медиана, минимум и
+// максимум. Результаты пишутся и в файл: .csv — таблица, иначе JSON.
+// Запуск: pipeline_benchmark [остановок через запятую] [повторов] [запросов] [файл результатов] [потоков] [способ поиска]
+int main(int argc, char *argv[])
+{
+    const std::vector<size_t> sizes = ParseSizes(argc > 1 ? argv[1] : "1000,2000,5000");
+    const size_t repeats = argc > 2 ? std::stoul(argv[2]) : 3;
+    const size_t requests_count = argc > 3 ? std::stoul(argv[3]) : 2000;
+    const std::string results_file = argc > 4 ? argv[4] : "";
+    const size_t threads_count = argc > 5 ? std::stoul(argv[5]) : 1;
+    const std::string routing_engine = argc > 6 ? argv[6] : "auto";
+
+    std::vector<SizeResult> results;
+    std::cout << "stops\tphase\tmedian_s\tmin_s\tmax_s" << std::endl;
+    for (const size_t stops_count : sizes)
+    {
+        bench::CitySettings settings;
+        settings.stops_count = stops_count;
+        settings.buses_count = std::max<size_t>(1, stops_count * 3 / 20);
+        settings.requests_count = requests_count;
+        settings.mix = {0.2, 0.2, 0.5, 0.005, 0.02, 0.075};
+        settings.routing_engine = routing_engine;
+        std::ostringstream input;
+        json::Print(json::Document(bench::MakeCity(settings)), input);
+        const std::string input_text = input.str();
+
+        std::vector<std::string> phases;
+        std::map<std::string, std::vector<double>> samples;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            for (const auto &[phase, seconds] : RunPipeline(input_text, threads_count))
+            {
+                if (!samples.count(phase))
+                {
+                    phases.push_back(phase);
+                }
+                samples[phase].push_back(seconds);
+            }
+        }
+
+        SizeResult result{stops_count, settings.buses_count, requests_count, {}};
+        for (const auto &phase : phases)
+        {
+            const auto &values = samples.at(phase);
+            result.phases.push_back({phase, bench::Median(values), *std::min_element(values.begin(), values.end()), *std::max_element(values.begin(), values.end())});
+            const auto &last = result.phases.back();
+            std::cout << stops_count << '\t' << phase << '\t' << last.median_s << '\t' << last.min_s << '\t' << last.max_s << std::endl;
+        }
+        results.push_back(std::move(result));
+    }
+
+    if (!results_file.empty())
+    {
+        std::ofstream output(results_file);
+        if (!output)
+        {
+            std::cerr << "error: cannot write " << results_file << std::endl;
+            return 1;
+        }
+        if (results_file.size() >= 4 && results_file.substr(results_file.size() - 4) == ".csv")
+        {
+            WriteCsv(output, results);
+        }
+        else
+        {
+            WriteJson(output, results, repeats, threads_count);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Route-запросы со своими bus_wait_time и bus_velocity: отдельный граф с поиском Дейкстры на каждый профиль
+// против одного TransportRouter, который ищет маршрут профиля по линиям RAPTOR. Запросы профиля задаются
+// дважды: первый проход — промахи кэша профилей, второй — попадания. Время в пути сверяется с графом профиля.
+// Запуск: profile_routes_benchmark [сторона сетки] [профилей] [запросов на профиль]
+int main(int argc, char *argv[])
+{
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 30;
+    const size_t profiles_count = argc > 2 ? std::stoul(argv[2]) : 4;
+    const size_t queries_count = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(bench::MakeGridBase(side), catalogue);
+    const size_t stops_count = side * side;
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<size_t> stop(0, stops_count - 1);
+    std::vector<std::pair<size_t, size_t>> queries(queries_count);
+    for (auto &[from, to] : queries)
+    {
+        from = stop(generator);
+        to = stop(generator);
+    }
+    std::uniform_int_distribution<int> wait_time(0, 30);
+    std::uniform_int_distribution<int> velocity(5, 120);
+    std::vector<router::RoutingProfile> profiles(profiles_count);
+    for (auto &profile : profiles)
+    {
+        profile = {wait_time(generator), velocity(generator)};
+    }
+
+    const router::RoutingSettings settings = bench::MakeRoutingSettings(router::RoutingEngine::DIJKSTRA);
+    const router::TransportRouter transport_router(settings, catalogue);
+    auto search = transport_router.CreateSearch();
+
+    std::cout << "stops: " << stops_count << ", profiles: " << profiles_count << ", queries per profile: " << queries_count << std::endl;
+    std::cout << "bus_wait_time\tbus_velocity\tgraph_build_s\tgraph_route_us\tprofile_miss_us\tprofile_hit_us" << std::endl;
+    for (const auto &profile : profiles)
+    {
+        const router::RoutingSettings profile_settings = bench::MakeRoutingSettings(router::RoutingEngine::DIJKSTRA, profile.bus_wait_time, profile.bus_velocity);
+        double build = 0.0;
+        const auto profile_router = bench::BuildRouter(profile_settings, catalogue, build);
+        auto profile_search = profile_router->CreateSearch();
+        std::vector<std::optional<router::RouteItems>> expected(queries.size());
+        const double graph_routes = bench::MeasureSeconds([&]
+                                                          {
+            for (size_t index = 0; index < queries.size(); ++index)
+            {
+                expected[index] = profile_router->GetRouteInfo(queries[index].first, queries[index].second, profile_search);
+            } });
+
+        std::vector<double> pass_times;
+        for (size_t pass = 0; pass < 2; ++pass)
+        {
+            std::vector<std::optional<router::RouteItems>> routes(queries.size());
+            pass_times.push_back(bench::MeasureSeconds([&]
+                                                       {
+                for (size_t index = 0; index < queries.size(); ++index)
+                {
+                    routes[index] = transport_router.GetRouteInfo(queries[index].first, queries[index].second, profile, search);
+                } }));
+            for (size_t index = 0; index < queries.size(); ++index)
+            {
+                if (routes[index].has_value() != expected[index].has_value() || (routes[index] && std::abs(bench::GetTotalTime(*routes[index]) - bench::GetTotalTime(*expected[index])) > 1e-6))
+                {
+                    std::cerr << "error: total_time differs from the profile graph for bus_wait_time " << profile.bus_wait_time << ", bus_velocity " << profile.bus_velocity << std::endl;
+                    return 1;
+                }
+            }
+        }
+        const double count = static_cast<double>(queries.size());
+        std::cout << profile.bus_wait_time << '\t' << profile.bus_velocity << '\t' << build << '\t' << graph_routes / count * 1e6 << '\t'
+                  << pass_times[0] / count * 1e6 << '\t' << pass_times[1] / count * 1e6 << std::endl;
+    }
+
+    std::cout << "bus_wait_time\tbus_velocity\thits\tmisses\tevictions\tcached_routes" << std::endl;
+    for (const auto &stats : transport_router.GetProfileCacheStats())
+    {
+        std::cout << stats.profile.bus_wait_time << '\t' << stats.profile.bus_velocity << '\t' << stats.hits << '\t' << stats.misses << '\t' << stats.evictions << '\t' << stats.entries << std::endl;
+    }
+}
@@ -0,0 +1,135 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// RAPTOR против поиска Дейкстры по графу пересадок: подготовка, память, время одиночного Route-запроса
+// и поиска из одной остановки во все, в том числе с просмотром линий раунда на нескольких потоках.
+// Запуск: raptor_benchmark [сторона сетки] [число запросов] [повторы] [максимум потоков]
+int main(int argc, char *argv[])
+{
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 40;
+    const size_t queries_count = argc > 2 ? std::stoul(argv[2]) : 2000;
+    const size_t repeats = argc > 3 ? std::stoul(argv[3]) : 3;
+    const size_t max_threads = argc > 4 ? std::stoul(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(bench::MakeGridBase(side), catalogue);
+    const size_t stops_count = side * side;
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<size_t> stop(0, stops_count - 1);
+    std::vector<std::pair<size_t, size_t>> queries(queries_count);
+    for (auto &[from, to] : queries)
+    {
+        from = stop(generator);
+        to = stop(generator);
+    }
+    std::vector<size_t> all_stops(stops_count);
+    for (size_t i = 0; i < stops_count; ++i)
+    {
+        all_stops[i] = i;
+    }
+
+    std::cout << "stops: " << stops_count << ", queries: " << queries_count << ", repeats: " << repeats << std::endl;
+    std::cout << "engine\tpreprocessing_s\tmemory_mb\troute_us\tone_to_all_us" << std::endl;
+
+    // RAPTOR строится первым, чтобы прирост занятой памяти не включал освобождённый граф
+    std::vector<std::optional<double>> reference_times;
+    std::vector<std::optional<double>> reference_row;
+    std::vector<std::unique_ptr<router::TransportRouter>> routers;
+    for (const auto engine : {router::RoutingEngine::RAPTOR, router::RoutingEngine::DIJKSTRA})
+    {
+        const router::RoutingSettings settings = bench::MakeRoutingSettings(engine);
+        const size_t resident_before = bench::GetResidentBytes();
+        const double preprocessing = bench::MeasureSeconds([&]
+                                                           { routers.push_back(std::make_unique<router::TransportRouter>(settings, catalogue)); });
+        const size_t memory = bench::GetResidentBytes() - resident_before;
+        const auto &transport_router = *routers.back();
+        auto search = transport_router.CreateSearch();
+
+        std::vector<std::optional<double>> total_times(queries.size());
+        std::vector<double> route_times;
+        std::vector<double> row_times;
+        std::vector<std::vector<std::optional<double>>> row;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            route_times.push_back(bench::MeasureSeconds([&]
+                                                        {
+                for (size_t index = 0; index < queries.size(); ++index)
+                {
+                    const auto times = transport_router.GetTotalTimes({queries[index].first}, {queries[index].second}, 1);
+                    total_times[index] = times[0][0];
+                } }));
+            row_times.push_back(bench::MeasureSeconds([&]
+                                                      { row = transport_router.GetTotalTimes({queries[0].first}, all_stops, 1); }));
+        }
+        if (reference_times.empty())
+        {
+            reference_times = total_times;
+            reference_row = row[0];
+        }
+        for (size_t index = 0; index < queries.size(); ++index)
+        {
+            if (total_times[index].has_value() != reference_times[index].has_value() || (total_times[index] && std::abs(*total_times[index] - *reference_times[index]) > 1e-6))
+            {
+                std::cerr << "error: " << router::GetEngineName(engine) << " total_time differs from raptor for query " << index << std::endl;
+                return 1;
+            }
+        }
+        for (size_t column = 0; column < stops_count; ++column)
+        {
+            if (row[0][column].has_value() != reference_row[column].has_value() || (row[0][column] && std::abs(*row[0][column] - *reference_row[column]) > 1e-6))
+            {
+                std::cerr << "error: " << router::GetEngineName(engine) << " one-to-all total_time differs from raptor" << std::endl;
+                return 1;
+            }
+        }
+        std::cout << router::GetEngineName(engine) << '\t' << preprocessing << '\t' << bench::ToMegabytes(memory) << '\t'
+                  << bench::Median(route_times) / static_cast<double>(queries.size()) * 1e6 << '\t' << bench::Median(row_times) * 1e6 << std::endl;
+    }
+
+    // Линии одного раунда на нескольких потоках: один поиск из остановки во все
+    std::unordered_map<std::string_view, size_t> stops_ids;
+    for (const auto stop_name : catalogue.GetStopsName())
+    {
+        stops_ids.emplace(stop_name, stops_ids.size());
+    }
+    const router::Raptor raptor(catalogue, stops_ids, 6, 40);
+    auto search = raptor.CreateSearch();
+    std::cout << "raptor lines memory: " << bench::ToMegabytes(raptor.GetMemoryBytes()) << " MB" << std::endl;
+    std::cout << "threads\tone_to_all_us\tspeedup" << std::endl;
+    double single_thread = 0.0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::vector<double> times;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            times.push_back(bench::MeasureSeconds([&]
+                                                  { raptor.Run(queries[0].first, std::nullopt, std::numeric_limits<double>::infinity(), search, threads); }));
+        }
+        for (size_t column = 0; column < stops_count; ++column)
+        {
+            const auto time = search.GetTime(column);
+            const auto &expected = reference_row[column];
+            if (time.has_value() != expected.has_value() || (time && std::abs(*time - *expected) > 1e-6))
+            {
+                std::cerr << "error: raptor on " << threads << " threads differs from one thread" << std::endl;
+                return 1;
+            }
+        }
+        const double seconds = bench::Median(times);
+        if (threads == 1)
+        {
+            single_thread = seconds;
+        }
+        std::cout << threads << '\t' << seconds * 1e6 << '\t' << single_thread / seconds << std::endl;
+    }
+}
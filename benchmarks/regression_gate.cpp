@@ -0,0 +1,349 @@
+#include "city_generator.h"
+#include "../transport-catalogue/json_builder.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    struct GateSettings
+    {
+        std::string baseline_file = "benchmarks/regression_baseline.json";
+        std::string results_file;
+        bool update = false;
+        size_t runs = 7;
+        double tolerance = 0.1; // допустимое замедление медианы, доля
+        double noise = 3.0;     // сколько MAD сверх допуска ещё считаются шумом
+        size_t stops_count = 400;
+        size_t queries_count = 1000;
+    };
+
+    struct MetricSummary
+    {
+        std::string name;
+        std::string unit;
+        double median = 0.0;
+        double mad = 0.0;
+    };
+
+    // Замеры метрик по всем прогонам в порядке первого появления
+    class MetricsCollector
+    {
+    public:
+        void Add(const std::string &name, std::string_view unit, double value)
+        {
+            const auto [it, inserted] = index_.emplace(name, metrics_.size());
+            if (inserted)
+            {
+                metrics_.push_back({name, std::string(unit), {}});
+            }
+            metrics_[it->second].samples.push_back(value);
+        }
+
+        std::vector<MetricSummary> Summarize() const
+        {
+            std::vector<MetricSummary> summaries;
+            for (const auto &metric : metrics_)
+            {
+                summaries.push_back({metric.name, metric.unit, bench::Median(metric.samples), bench::MedianAbsoluteDeviation(metric.samples)});
+            }
+            return summaries;
+        }
+
+    private:
+        struct Metric
+        {
+            std::string name;
+            std::string unit;
+            std::vector<double> samples;
+        };
+
+        std::vector<Metric> metrics_;
+        std::map<std::string, size_t> index_;
+    };
+
+    // Весь конвейер main.cpp; время стадий и запросов каждого типа берётся из сводки --stats
+    void MeasurePipeline(const std::string &input_text, MetricsCollector &metrics)
+    {
+        std::istringstream input(input_text);
+        std::ostringstream output;
+        guide::TransportCatalogue catalogue;
+        map_renderer::MapRenderer renderer;
+        stats::RunStats run_stats;
+        guide::FormTransportBaseAndRequests(input, catalogue, renderer, output, 1, &run_stats);
+        for (const auto &phase : run_stats.GetPhases())
+        {
+            metrics.Add("pipeline." + phase.name, "ms", phase.wall_time * 1e3);
+        }
+    }
+
+    void MeasureBusInfo(const guide::TransportCatalogue &catalogue, MetricsCollector &metrics)
+    {
+        constexpr size_t REPEATS = 20;
+        const auto &buses = catalogue.GetBuses();
+        double sink = 0.0;
+        const double seconds = bench::MeasureSeconds([&]
+                                                     {
+            for (size_t repeat = 0; repeat < REPEATS; ++repeat)
+            {
+                for (const auto &[bus, stops] : buses)
+                {
+                    sink += catalogue.GetBusInfo(bus).route_length;
+                }
+            } });
+        metrics.Add("catalogue.get_bus_info", "us", sink > 0.0 ? seconds * 1e6 / static_cast<double>(REPEATS * buses.size()) : 0.0);
+    }
+
+    void MeasureMap(const guide::TransportCatalogue &catalogue, map_renderer::MapRenderer &renderer, MetricsCollector &metrics)
+    {
+        std::ostringstream output;
+        metrics.Add("map.draw_map", "ms", bench::MeasureSeconds([&]
+                                                                 { renderer.DrawMap(output, catalogue); }) *
+                                               1e3);
+    }
+
+    // Построение TransportRouter и среднее время GetRouteInfo на одних и тех же парах остановок
+    void MeasureRouter(guide::TransportCatalogue &catalogue, router::RoutingEngine engine, const std::vector<std::pair<size_t, size_t>> &queries, MetricsCollector &metrics)
+    {
+        const router::RoutingSettings settings = bench::MakeRoutingSettings(engine);
+        double build = 0.0;
+        const auto transport_router = bench::BuildRouter(settings, catalogue, build);
+        std::vector<size_t> stop_ids;
+        for (const auto &[from, to] : queries)
+        {
+            stop_ids.push_back(*transport_router->FindStopId(bench::CityStopName(from)));
+            stop_ids.push_back(*transport_router->FindStopId(bench::CityStopName(to)));
+        }
+        auto search = transport_router->CreateSearch();
+        size_t found = 0;
+        const double seconds = bench::MeasureSeconds([&]
+                                                     {
+            for (size_t index = 0; index < queries.size(); ++index)
+            {
+                found += transport_router->GetRouteInfo(stop_ids[2 * index], stop_ids[2 * index + 1], search) ? 1 : 0;
+            } });
+        const std::string prefix = "router." + std::string(router::GetEngineName(engine));
+        metrics.Add(prefix + ".build", "ms", build * 1e3);
+        metrics.Add(prefix + ".route", "us", found > 0 ? seconds * 1e6 / static_cast<double>(queries.size()) : 0.0);
+    }
+
+    json::Node ToJson(const std::vector<MetricSummary> &summaries, const GateSettings &settings)
+    {
+        json::Builder builder;
+        builder.StartDict().Key("benchmark").Value(std::string("regression_gate")).Key("runs").Value(static_cast<int>(settings.runs));
+        builder.Key("stops").Value(static_cast<int>(settings.stops_count)).Key("queries").Value(static_cast<int>(settings.queries_count)).Key("metrics").StartArray();
+        for (const auto &summary : summaries)
+        {
+            builder.StartDict().Key("metric").Value(summary.name).Key("unit").Value(summary.unit).Key("median").Value(summary.median).Key("mad").Value(summary.mad).EndDict();
+        }
+        builder.EndArray().EndDict();
+        return builder.Build();
+    }
+
+    std::vector<MetricSummary> FromJson(const json::Node &root)
+    {
+        std::vector<MetricSummary> summaries;
+        for (const auto &item : root.AsMap().at("metrics").AsArray())
+        {
+            const json::Dict &metric = item.AsMap();
+            summaries.push_back({metric.at("metric").AsString(), metric.at("unit").AsString(), metric.at("median").AsDouble(), metric.at("mad").AsDouble()});
+        }
+        return summaries;
+    }
+
+    // Регрессия — медиана выросла больше чем на tolerance и ещё на noise оценок σ по MAD (1.4826 · MAD) сверх того.
+    // Печатает таблицу сравнения и возвращает число регрессий
+    size_t Compare(const std::vector<MetricSummary> &baseline, const std::vector<MetricSummary> &current, const GateSettings &settings)
+    {
+        std::map<std::string, const MetricSummary *> baseline_by_name;
+        for (const auto &summary : baseline)
+        {
+            baseline_by_name[summary.name] = &summary;
+        }
+        size_t regressions = 0;
+        std::cout << std::left << std::setw(40) << "metric" << std::right << std::setw(14) << "baseline" << std::setw(14) << "current" << std::setw(10) << "change"
+                  << std::setw(14) << "allowed" << "  status" << std::endl;
+        std::cout << std::fixed << std::setprecision(3);
+        for (const auto &summary : current)
+        {
+            const auto it = baseline_by_name.find(summary.name);
+            std::cout << std::left << std::setw(40) << summary.name + ", " + summary.unit << std::right;
+            if (it == baseline_by_name.end())
+            {
+                std::cout << std::setw(14) << "-" << std::setw(14) << summary.median << std::setw(10) << "-" << std::setw(14) << "-" << "  new" << std::endl;
+                continue;
+            }
+            const MetricSummary &base = *it->second;
+            baseline_by_name.erase(it);
+            const double spread = settings.noise * 1.4826 * std::max(base.mad, summary.mad);
+            const double allowed = base.median * (1.0 + settings.tolerance) + spread;
+            const double change = base.median > 0.0 ? (summary.median / base.median - 1.0) * 100.0 : 0.0;
+            std::string status = "ok";
+            if (summary.median > allowed)
+            {
+                status = "REGRESSION";
+                ++regressions;
+            }
+            else if (summary.median < base.median * (1.0 - settings.tolerance) - spread)
+            {
+                status = "faster";
+            }
+            std::ostringstream change_text;
+            change_text << std::showpos << std::fixed << std::setprecision(1) << change << '%';
+            std::cout << std::setw(14) << base.median << std::setw(14) << summary.median << std::setw(10) << change_text.str() << std::setw(14) << allowed << "  " << status << std::endl;
+        }
+        for (const auto &[name, summary] : baseline_by_name)
+        {
+            std::cout << std::left << std::setw(40) << name + ", " + summary->unit << std::right << std::setw(14) << summary->median << std::setw(14) << "-"
+                      << std::setw(10) << "-" << std::setw(14) << "-" << "  missing" << std::endl;
+        }
+        std::cout.unsetf(std::ios::floatfield);
+        return regressions;
+    }
+
+    bool WriteJsonFile(const std::string &file, const json::Node &root)
+    {
+        std::ofstream output(file);
+        if (!output)
+        {
+            std::cerr << "error: cannot write " << file << std::endl;
+            return false;
+        }
+        json::Print(json::Document(root), output);
+        output << '\n';
+        return true;
+    }
+}
+
+// Проверка производительности против сохранённой базовой линии. Каждый прогон измеряет весь конвейер main.cpp
+// на синтетическом городе (время стадий и запросов каждого типа из сводки --stats), GetBusInfo, DrawMap и для
+// нескольких способов поиска — построение TransportRouter и Route-запрос. По прогонам берутся медиана и MAD.
+// Метрика регрессирует, если её медиана больше медианы базовой линии на tolerance и ещё на noise · 1.4826 · MAD;
+// тогда печатается таблица сравнения и код возврата — 1. С --update базовая линия перезаписывается.
+// Запуск из корня репозитория:
+// regression_gate [--baseline=benchmarks/regression_baseline.json] [--update] [--results=FILE] [--runs=7]
+//                 [--tolerance=0.1] [--noise=3] [--stops=400] [--queries=1000]
+int main(int argc, char *argv[])
+{
+    GateSettings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg == "--update")
+        {
+            settings.update = true;
+            continue;
+        }
+        const size_t equals = arg.find('=');
+        if (arg.substr(0, 2) != "--" || equals == std::string_view::npos)
+        {
+            std::cerr << "error: expected --name=value or --update, got " << arg << std::endl;
+            return 2;
+        }
+        const std::string name(arg.substr(2, equals - 2));
+        const std::string value(arg.substr(equals + 1));
+        if (name == "baseline")
+        {
+            settings.baseline_file = value;
+        }
+        else if (name == "results")
+        {
+            settings.results_file = value;
+        }
+        else if (name == "runs")
+        {
+            settings.runs = std::max<size_t>(1, std::stoul(value));
+        }
+        else if (name == "tolerance")
+        {
+            settings.tolerance = std::stod(value);
+        }
+        else if (name == "noise")
+        {
+            settings.noise = std::stod(value);
+        }
+        else if (name == "stops")
+        {
+            settings.stops_count = std::stoul(value);
+        }
+        else if (name == "queries")
+        {
+            settings.queries_count = std::stoul(value);
+        }
+        else
+        {
+            std::cerr << "error: unknown option --" << name << std::endl;
+            return 2;
+        }
+    }
+
+    bench::CitySettings city_settings;
+    city_settings.stops_count = settings.stops_count;
+    city_settings.buses_count = std::max<size_t>(1, settings.stops_count * 3 / 20);
+    city_settings.requests_count = 2000;
+    city_settings.mix = {0.2, 0.2, 0.6, 0.001, 0.0, 0.0};
+    city_settings.routing_engine = "all_pairs";
+    const json::Dict city = bench::MakeCity(city_settings);
+    std::ostringstream input;
+    json::Print(json::Document(city), input);
+    const std::string input_text = input.str();
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(city.at("base_requests").AsArray(), catalogue);
+    map_renderer::MapRenderer renderer;
+    guide::SetRenderSettings(city.at("render_settings").AsMap(), renderer);
+    bench::CityRandom random(11);
+    std::vector<std::pair<size_t, size_t>> queries(settings.queries_count);
+    for (auto &[from, to] : queries)
+    {
+        from = random.Index(settings.stops_count);
+        to = random.Index(settings.stops_count);
+    }
+    const std::vector<router::RoutingEngine> engines{router::RoutingEngine::ALL_PAIRS, router::RoutingEngine::DIJKSTRA, router::RoutingEngine::BIDIRECTIONAL, router::RoutingEngine::RAPTOR};
+
+    MetricsCollector metrics;
+    for (size_t run = 0; run < settings.runs; ++run)
+    {
+        std::cerr << "run " << run + 1 << '/' << settings.runs << std::endl;
+        MeasurePipeline(input_text, metrics);
+        MeasureBusInfo(catalogue, metrics);
+        MeasureMap(catalogue, renderer, metrics);
+        for (const auto engine : engines)
+        {
+            MeasureRouter(catalogue, engine, queries, metrics);
+        }
+    }
+    const std::vector<MetricSummary> current = metrics.Summarize();
+    if (!settings.results_file.empty() && !WriteJsonFile(settings.results_file, ToJson(current, settings)))
+    {
+        return 2;
+    }
+    if (settings.update)
+    {
+        return WriteJsonFile(settings.baseline_file, ToJson(current, settings)) ? 0 : 2;
+    }
+
+    std::ifstream baseline_input(settings.baseline_file);
+    if (!baseline_input)
+    {
+        std::cerr << "error: cannot read baseline " << settings.baseline_file << " (create it with --update)" << std::endl;
+        return 2;
+    }
+    const json::Document baseline = json::Load(baseline_input);
+    const size_t regressions = Compare(FromJson(baseline.GetRoot()), current, settings);
+    if (regressions > 0)
+    {
+        std::cout << "FAIL: " << regressions << " metric(s) slower than baseline by more than " << settings.tolerance * 100.0 << "% + " << settings.noise << " MAD" << std::endl;
+        return 1;
+    }
+    std::cout << "OK: no metric slower than baseline by more than " << settings.tolerance * 100.0 << "% + " << settings.noise << " MAD" << std::endl;
+}
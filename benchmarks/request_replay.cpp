@@ -0,0 +1,209 @@
+#include "../transport-catalogue/json_reader.h"
+#include "../transport-catalogue/parallel.h"
+#include "../transport-catalogue/request_log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct ReplaySettings
+    {
+        std::string log_file;
+        double speed = 1.0; // 0 — без пауз, запросы подряд
+        size_t threads_count = parallel::DefaultThreadsCount();
+        size_t max_diffs = 10;
+    };
+
+    // Итог одного повторённого запроса
+    struct ReplayResult
+    {
+        double response_time = 0.0; // от назначенного момента отправки до ответа: включает ожидание свободного потока
+        double service_time = 0.0;  // только FormAnswer
+        json::Node answer;
+    };
+
+    std::string ToText(const json::Node &node)
+    {
+        std::ostringstream output;
+        output << node;
+        return output.str();
+    }
+
+    // Длинные ответы (карты) в отчёте обрезаются
+    std::string Shorten(const std::string &text, size_t limit = 300)
+    {
+        return text.size() <= limit ? text : text.substr(0, limit) + "... (" + std::to_string(text.size()) + " bytes)";
+    }
+
+    void PrintLatencyRow(std::string_view name, const stats::LatencyHistogram &histogram)
+    {
+        std::cout << std::left << std::setw(24) << name << std::right << std::setw(8) << histogram.GetCount();
+        for (const double share : {0.5, 0.9, 0.99, 0.999})
+        {
+            std::cout << std::setw(10) << histogram.GetPercentile(share) * 1e3;
+        }
+        std::cout << std::setw(10) << histogram.GetMax() * 1e3 << std::endl;
+    }
+}
+
+// Повтор журнала transport_catalogue --record=FILE: справочник и маршрутизатор строятся по снимку базы, запросы
+// отправляются на threads потоках в моменты из журнала, делённые на speed (--speed=max — без пауз). Печатает
+// пропускную способность, процентили времени ответа (от назначенного момента отправки) и обслуживания по типам
+// запросов и расхождения ответов с записанными; при расхождениях код возврата — 1.
+// request_replay LOG [--speed=1|N|max] [--threads=N] [--max_diffs=10]
+int main(int argc, char *argv[])
+{
+    ReplaySettings settings;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+        if (arg.substr(0, 2) != "--")
+        {
+            settings.log_file = std::string(arg);
+            continue;
+        }
+        const size_t equals = arg.find('=');
+        if (equals == std::string_view::npos)
+        {
+            std::cerr << "error: expected --name=value, got " << arg << std::endl;
+            return 2;
+        }
+        const std::string name(arg.substr(2, equals - 2));
+        const std::string value(arg.substr(equals + 1));
+        if (name == "speed")
+        {
+            settings.speed = value == "max" ? 0.0 : std::stod(value);
+        }
+        else if (name == "threads")
+        {
+            settings.threads_count = std::max<size_t>(1, std::stoul(value));
+        }
+        else if (name == "max_diffs")
+        {
+            settings.max_diffs = std::stoul(value);
+        }
+        else
+        {
+            std::cerr << "error: unknown option --" << name << std::endl;
+            return 2;
+        }
+    }
+    std::ifstream input(settings.log_file);
+    if (settings.log_file.empty() || !input)
+    {
+        std::cerr << "usage: request_replay LOG [--speed=1|N|max] [--threads=N] [--max_diffs=10]" << std::endl;
+        return 2;
+    }
+    const request_log::RequestLog log = request_log::FromJson(json::Load(input).GetRoot());
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(log.snapshot.at("base_requests").AsArray(), catalogue);
+    map_renderer::MapRenderer renderer;
+    guide::SetRenderSettings(log.snapshot.at("render_settings").AsMap(), renderer);
+    const auto build_start = Clock::now();
+    router::TransportRouter transport_router(guide::ParseRoutingSettings(log.snapshot.at("routing_settings").AsMap(), settings.threads_count), catalogue);
+    const double build_time = std::chrono::duration<double>(Clock::now() - build_start).count();
+    guide::RequestHandler handler(catalogue, renderer, transport_router);
+    const std::vector<guide::StatRequest> requests = guide::ParseStatRequests(log.requests, catalogue, transport_router);
+    // Ответы сопоставляются с запросами по номеру, поэтому пропущенный при разборе запрос сдвинул бы все следующие
+    if (requests.size() != log.requests.size())
+    {
+        std::cerr << "error: " << log.requests.size() - requests.size() << " of " << log.requests.size() << " recorded requests have unknown types" << std::endl;
+        return 2;
+    }
+
+    // Запросы уходят в порядке записанных моментов; потоки разбирают их через общий счётчик
+    std::vector<size_t> order(requests.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs)
+                     { return log.offsets[lhs] < log.offsets[rhs]; });
+    const double first_offset = order.empty() ? 0.0 : log.offsets[order.front()];
+
+    std::vector<ReplayResult> results(requests.size());
+    std::vector<guide::RequestScratch> scratches(settings.threads_count);
+    const auto start = Clock::now();
+    parallel::ForEachIndex(order.size(), scratches.size(), [&](size_t position, size_t thread_index)
+                           {
+        const size_t index = order[position];
+        const auto scheduled = settings.speed > 0.0
+                                   ? start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>((log.offsets[index] - first_offset) / settings.speed))
+                                   : Clock::now();
+        std::this_thread::sleep_until(scheduled);
+        const auto issued = Clock::now();
+        ReplayResult &result = results[index];
+        result.answer = handler.FormAnswer(requests[index], scratches[thread_index]);
+        const auto done = Clock::now();
+        result.response_time = std::chrono::duration<double>(done - scheduled).count();
+        result.service_time = std::chrono::duration<double>(done - issued).count(); });
+    const double wall_time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    stats::LatencyHistogram response_times;
+    std::vector<std::pair<std::string_view, stats::LatencyHistogram>> service_times;
+    size_t diffs = 0;
+    for (size_t index = 0; index < requests.size(); ++index)
+    {
+        const ReplayResult &result = results[index];
+        response_times.Record(result.response_time);
+        const std::string_view type = guide::GetRequestTypeName(requests[index].type);
+        auto it = std::find_if(service_times.begin(), service_times.end(), [type](const auto &item)
+                               { return item.first == type; });
+        if (it == service_times.end())
+        {
+            it = service_times.emplace(service_times.end(), type, stats::LatencyHistogram{});
+        }
+        it->second.Record(result.service_time);
+
+        // Ответы сравниваются так, как их печатает transport_catalogue: числа с точностью потока по умолчанию
+        const std::string expected = ToText(log.responses[index]);
+        const std::string actual = ToText(result.answer);
+        if (expected == actual)
+        {
+            continue;
+        }
+        if (++diffs <= settings.max_diffs)
+        {
+            std::cout << "diff in request " << ToText(log.requests[index]) << '\n'
+                      << "  recorded: " << Shorten(expected) << '\n'
+                      << "  replayed: " << Shorten(actual) << std::endl;
+        }
+    }
+
+    const double recorded_span = order.empty() ? 0.0 : log.offsets[order.back()] - first_offset;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "requests: " << requests.size() << ", threads: " << scratches.size() << ", speed: ";
+    if (settings.speed > 0.0)
+    {
+        std::cout << settings.speed << 'x';
+    }
+    else
+    {
+        std::cout << "max";
+    }
+    std::cout << ", engine: " << router::GetEngineName(transport_router.GetEngine()) << " (built in " << build_time << " s)" << std::endl;
+    std::cout << "recorded span: " << recorded_span << " s, replay: " << wall_time << " s, throughput: " << std::setprecision(1)
+              << (wall_time > 0.0 ? static_cast<double>(requests.size()) / wall_time : 0.0) << " requests/s" << std::endl;
+    std::cout << std::setprecision(3) << std::left << std::setw(24) << "latency, ms" << std::right << std::setw(8) << "count" << std::setw(10) << "p50"
+              << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max" << std::endl;
+    if (settings.speed > 0.0)
+    {
+        PrintLatencyRow("response", response_times);
+    }
+    for (const auto &[type, histogram] : service_times)
+    {
+        PrintLatencyRow(type, histogram);
+    }
+    std::cout << "answer diffs: " << diffs << " of " << requests.size() << std::endl;
+    return diffs > 0 ? 1 : 0;
+}
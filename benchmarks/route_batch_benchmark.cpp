@@ -0,0 +1,85 @@
+#include "bench_utils.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Выигрыш от группировки Route-запросов по остановке отправления в режиме без таблицы всех пар.
+// Запуск: route_batch_benchmark [сторона сетки] [число запросов] [повторы]
+int main(int argc, char *argv[])
+{
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 30;
+    const size_t requests_count = argc > 2 ? std::stoul(argv[2]) : 2000;
+    const size_t repeats = argc > 3 ? std::stoul(argv[3]) : 3;
+
+    guide::TransportCatalogue catalogue;
+    guide::FormTransportBase(bench::MakeGridBase(side), catalogue);
+    const router::RoutingSettings settings = bench::MakeRoutingSettings(router::RoutingEngine::DIJKSTRA);
+    router::TransportRouter transport_router(settings, catalogue);
+    auto search = transport_router.CreateSearch();
+    const size_t stops_count = side * side;
+
+    std::cout << "stops: " << stops_count << ", requests: " << requests_count << ", repeats: " << repeats << std::endl;
+    std::cout << "origins\trequests_per_origin\tper_request_s\tgrouped_s\tspeedup" << std::endl;
+
+    for (const size_t divisor : {1, 2, 4, 10, 50, 200, 1000})
+    {
+        const size_t origins_count = std::max<size_t>(1, std::min(stops_count, requests_count / divisor));
+        std::mt19937 generator(7);
+        std::uniform_int_distribution<size_t> stop(0, stops_count - 1);
+        std::vector<size_t> origins(origins_count);
+        for (auto &origin : origins)
+        {
+            origin = stop(generator);
+        }
+        std::uniform_int_distribution<size_t> origin_index(0, origins_count - 1);
+        std::vector<std::pair<size_t, size_t>> routes(requests_count);
+        for (auto &[from, to] : routes)
+        {
+            from = origins[origin_index(generator)];
+            to = stop(generator);
+        }
+
+        std::vector<double> per_request_times;
+        std::vector<double> grouped_times;
+        size_t checksum_per_request = 0;
+        size_t checksum_grouped = 0;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            per_request_times.push_back(bench::MeasureSeconds([&]
+                                                              {
+                checksum_per_request = 0;
+                for (const auto &[from, to] : routes)
+                {
+                    const auto route = transport_router.GetRouteInfo(from, to, search);
+                    checksum_per_request += route ? route->size() : 0;
+                } }));
+            grouped_times.push_back(bench::MeasureSeconds([&]
+                                                          {
+                checksum_grouped = 0;
+                std::map<size_t, std::vector<size_t>> groups;
+                for (const auto &[from, to] : routes)
+                {
+                    groups[from].push_back(to);
+                }
+                for (const auto &[from, to] : groups)
+                {
+                    for (const auto &route : transport_router.GetRoutesInfo(from, to, search))
+                    {
+                        checksum_grouped += route ? route->size() : 0;
+                    }
+                } }));
+        }
+        if (checksum_per_request != checksum_grouped)
+        {
+            std::cerr << "warning: itinerary lengths differ (equal-time alternatives)" << std::endl;
+        }
+        const double per_request = bench::Median(per_request_times);
+        const double grouped = bench::Median(grouped_times);
+        std::cout << origins_count << '\t' << static_cast<double>(requests_count) / static_cast<double>(origins_count) << '\t'
+                  << per_request << '\t' << grouped << '\t' << per_request / grouped << std::endl;
+    }
+}
@@ -0,0 +1,278 @@
+#include "alloc_counter.h"
+#include "city_generator.h"
+#include "../transport-catalogue/json_reader.h"
+#include "../transport-catalogue/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Веса рёбер — десятые доли из [0.1, 10]: так графы разной формы сравнимы между собой
+    double MakeWeight(bench::CityRandom &random)
+    {
+        return static_cast<double>(1 + random.Index(100)) / 10.0;
+    }
+
+    void AddBothWays(graph::DirectedWeightedGraph<double> &graph, graph::VertexId from, graph::VertexId to, double weight)
+    {
+        graph.AddEdge({from, to, weight});
+        graph.AddEdge({to, from, weight});
+    }
+
+    // Решётка side x side: рёбра в обе стороны между соседями по строке и столбцу
+    graph::DirectedWeightedGraph<double> MakeGridGraph(size_t vertex_count, bench::CityRandom &random)
+    {
+        const size_t side = std::max<size_t>(2, static_cast<size_t>(std::sqrt(static_cast<double>(vertex_count))));
+        graph::DirectedWeightedGraph<double> graph(side * side);
+        for (size_t row = 0; row < side; ++row)
+        {
+            for (size_t column = 0; column < side; ++column)
+            {
+                const graph::VertexId vertex = row * side + column;
+                if (column + 1 < side)
+                {
+                    AddBothWays(graph, vertex, vertex + 1, MakeWeight(random));
+                }
+                if (row + 1 < side)
+                {
+                    AddBothWays(graph, vertex, vertex + side, MakeWeight(random));
+                }
+            }
+        }
+        return graph;
+    }
+
+    // Похожий на транспорт граф: медленная линия через все вершины и линии по 10–30 вершин,
+    // которые перескакивают вперёд на 1–20 номеров и едут втрое быстрее
+    graph::DirectedWeightedGraph<double> MakeTransitGraph(size_t vertex_count, bench::CityRandom &random)
+    {
+        graph::DirectedWeightedGraph<double> graph(vertex_count);
+        for (graph::VertexId vertex = 0; vertex + 1 < vertex_count; ++vertex)
+        {
+            AddBothWays(graph, vertex, vertex + 1, MakeWeight(random));
+        }
+        for (size_t line = 0; line < vertex_count / 10; ++line)
+        {
+            graph::VertexId vertex = random.Index(vertex_count);
+            const size_t length = 10 + random.Index(21);
+            for (size_t i = 0; i < length; ++i)
+            {
+                const graph::VertexId next = (vertex + 1 + random.Index(20)) % vertex_count;
+                AddBothWays(graph, vertex, next, MakeWeight(random) / 3.0);
+                vertex = next;
+            }
+        }
+        return graph;
+    }
+
+    // Хабы (корень из числа вершин) связаны каждый с каждым; остальные вершины — с одним хабом,
+    // каждая третья ещё и со вторым
+    graph::DirectedWeightedGraph<double> MakeHubGraph(size_t vertex_count, bench::CityRandom &random)
+    {
+        graph::DirectedWeightedGraph<double> graph(vertex_count);
+        const size_t hubs_count = std::max<size_t>(2, static_cast<size_t>(std::sqrt(static_cast<double>(vertex_count))));
+        for (graph::VertexId from = 0; from < hubs_count; ++from)
+        {
+            for (graph::VertexId to = from + 1; to < hubs_count; ++to)
+            {
+                AddBothWays(graph, from, to, MakeWeight(random));
+            }
+        }
+        for (graph::VertexId vertex = hubs_count; vertex < vertex_count; ++vertex)
+        {
+            AddBothWays(graph, vertex, random.Index(hubs_count), MakeWeight(random));
+            if (random.Chance(1.0 / 3.0))
+            {
+                AddBothWays(graph, vertex, random.Index(hubs_count), MakeWeight(random));
+            }
+        }
+        return graph;
+    }
+
+    bool SameTime(const std::optional<double> &lhs, const std::optional<double> &rhs)
+    {
+        return lhs.has_value() == rhs.has_value() && (!lhs || std::abs(*lhs - *rhs) <= 1e-6);
+    }
+
+    // Время каждого вызова query(index) в микросекундах
+    template <typename Query>
+    std::vector<double> MeasureLatencies(size_t count, Query query)
+    {
+        std::vector<double> latencies;
+        latencies.reserve(count);
+        for (size_t index = 0; index < count; ++index)
+        {
+            latencies.push_back(bench::MeasureSeconds([&]
+                                                      { query(index); }) *
+                                1e6);
+        }
+        return latencies;
+    }
+
+    // graph::Router на графах разной формы: построение таблицы обоими способами, память, задержка BuildRoute.
+    // Веса маршрутов сверяются с поиском Дейкстры
+    bool RunGraphBenchmarks(size_t vertex_count, size_t queries_count)
+    {
+        std::cout << "shape\tvertices\tedges\tprecomputation\tbuild_s\tmemory_mb\troute_p50_us\troute_p99_us" << std::endl;
+        bench::CityRandom random(7);
+        const std::vector<std::pair<std::string, graph::DirectedWeightedGraph<double>>> graphs{
+            {"grid", MakeGridGraph(vertex_count, random)},
+            {"transit", MakeTransitGraph(vertex_count, random)},
+            {"hub", MakeHubGraph(vertex_count, random)}};
+        for (const auto &[shape, graph] : graphs)
+        {
+            std::vector<std::pair<graph::VertexId, graph::VertexId>> queries(queries_count);
+            for (auto &[from, to] : queries)
+            {
+                from = random.Index(graph.GetVertexCount());
+                to = random.Index(graph.GetVertexCount());
+            }
+            std::vector<std::optional<double>> expected(queries.size());
+            graph::Dijkstra<double> dijkstra(graph);
+            for (size_t index = 0; index < queries.size(); ++index)
+            {
+                dijkstra.BuildTree(queries[index].first, {queries[index].second});
+                expected[index] = dijkstra.GetWeight(queries[index].second);
+            }
+
+            for (const auto &[precomputation, name] : {std::pair{graph::RoutesPrecomputation::CLASSIC, "classic"}, std::pair{graph::RoutesPrecomputation::BLOCKED, "blocked"}})
+            {
+                std::unique_ptr<graph::Router<double>> router;
+                const size_t live_before = bench::GetLiveBytes();
+                const double build = bench::MeasureSeconds([&]
+                                                           { router = std::make_unique<graph::Router<double>>(graph, precomputation, parallel::DefaultThreadsCount()); });
+                const size_t memory = bench::GetLiveBytes() - live_before;
+                std::vector<std::optional<double>> weights(queries.size());
+                const auto latencies = MeasureLatencies(queries.size(), [&](size_t index)
+                                                        {
+                    const auto route = router->BuildRoute(queries[index].first, queries[index].second);
+                    weights[index] = route ? std::optional<double>(route->weight) : std::nullopt; });
+                for (size_t index = 0; index < queries.size(); ++index)
+                {
+                    if (!SameTime(weights[index], expected[index]))
+                    {
+                        std::cerr << "error: " << name << " graph::Router on " << shape << " differs from dijkstra for query " << index << std::endl;
+                        return false;
+                    }
+                }
+                std::cout << shape << '\t' << graph.GetVertexCount() << '\t' << graph.GetEdgeCount() << '\t' << name << '\t' << build << '\t'
+                          << bench::ToMegabytes(memory) << '\t' << bench::Percentile(latencies, 0.5) << '\t' << bench::Percentile(latencies, 0.99) << std::endl;
+            }
+        }
+        return true;
+    }
+
+    // TransportRouter::GetRouteInfo каждым способом поиска на одном синтетическом городе; времена в пути
+    // сверяются с первым способом
+    bool RunEngineBenchmarks(size_t stops_count, size_t queries_count, const std::vector<router::RoutingEngine> &engines)
+    {
+        bench::CitySettings settings;
+        settings.stops_count = stops_count;
+        settings.buses_count = std::max<size_t>(1, stops_count * 3 / 20);
+        settings.requests_count = 0;
+        const json::Dict city = bench::MakeCity(settings);
+        guide::TransportCatalogue catalogue;
+        guide::FormTransportBase(city.at("base_requests").AsArray(), catalogue);
+
+        bench::CityRandom random(11);
+        std::vector<std::pair<size_t, size_t>> queries(queries_count);
+        for (auto &[from, to] : queries)
+        {
+            from = random.Index(stops_count);
+            to = random.Index(stops_count);
+        }
+
+        std::cout << "engine\tstops\tbuild_s\tmemory_mb\troute_p50_us\troute_p99_us\troute_mean_us" << std::endl;
+        std::vector<std::optional<double>> expected;
+        for (const auto engine : engines)
+        {
+            const router::RoutingSettings settings = bench::MakeRoutingSettings(engine);
+            double build = 0.0;
+            const size_t live_before = bench::GetLiveBytes();
+            const auto transport_router = bench::BuildRouter(settings, catalogue, build);
+            const size_t memory = bench::GetLiveBytes() - live_before;
+            // Номера остановок в TransportRouter совпадают с номерами города: имена упорядочены одинаково
+            std::vector<size_t> stop_ids(stops_count);
+            for (size_t stop = 0; stop < stops_count; ++stop)
+            {
+                stop_ids[stop] = *transport_router->FindStopId(bench::CityStopName(stop));
+            }
+            auto search = transport_router->CreateSearch();
+            std::vector<std::optional<double>> total_times(queries.size());
+            const auto latencies = MeasureLatencies(queries.size(), [&](size_t index)
+                                                    {
+                const auto route = transport_router->GetRouteInfo(stop_ids[queries[index].first], stop_ids[queries[index].second], search);
+                total_times[index] = route ? std::optional<double>(bench::GetTotalTime(*route)) : std::nullopt; });
+            if (expected.empty())
+            {
+                expected = total_times;
+            }
+            for (size_t index = 0; index < queries.size(); ++index)
+            {
+                if (!SameTime(total_times[index], expected[index]))
+                {
+                    std::cerr << "error: " << router::GetEngineName(engine) << " total_time differs from " << router::GetEngineName(engines.front()) << " for query " << index << std::endl;
+                    return false;
+                }
+            }
+            double sum = 0.0;
+            for (const double latency : latencies)
+            {
+                sum += latency;
+            }
+            std::cout << router::GetEngineName(engine) << '\t' << stops_count << '\t' << build << '\t' << bench::ToMegabytes(memory) << '\t'
+                      << bench::Percentile(latencies, 0.5) << '\t' << bench::Percentile(latencies, 0.99) << '\t' << sum / static_cast<double>(latencies.size()) << std::endl;
+        }
+        return true;
+    }
+}
+
+// Обвязка для работы над маршрутизацией: graph::Router на решётке, транспортном графе и графе хабов
+// (построение, занятая после построения память, перцентили BuildRoute) и TransportRouter::GetRouteInfo всеми способами поиска на одном
+// городе city_generator. Ответы сверяются: веса graph::Router — с поиском Дейкстры, времена в пути способов — с первым.
+// Запуск: router_benchmark [вершин графа] [остановок города] [запросов] [способы через запятую]
+int main(int argc, char *argv[])
+{
+    const size_t vertex_count = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const size_t stops_count = argc > 2 ? std::stoul(argv[2]) : 500;
+    const size_t queries_count = argc > 3 ? std::stoul(argv[3]) : 2000;
+
+    const std::vector<router::RoutingEngine> all_engines{
+        router::RoutingEngine::DIJKSTRA, router::RoutingEngine::ALL_PAIRS, router::RoutingEngine::ALL_PAIRS_BLOCKED,
+        router::RoutingEngine::ASTAR, router::RoutingEngine::ALT, router::RoutingEngine::BIDIRECTIONAL,
+        router::RoutingEngine::HUB_LABELS, router::RoutingEngine::RAPTOR, router::RoutingEngine::OVERLAY,
+        router::RoutingEngine::PARETO_PROFILES};
+    std::vector<router::RoutingEngine> engines;
+    if (argc > 4)
+    {
+        std::istringstream input(argv[4]);
+        std::string name;
+        while (std::getline(input, name, ','))
+        {
+            const auto it = std::find_if(all_engines.begin(), all_engines.end(), [&name](router::RoutingEngine engine)
+                                         { return router::GetEngineName(engine) == name; });
+            if (it == all_engines.end())
+            {
+                std::cerr << "error: unknown routing engine " << name << std::endl;
+                return 1;
+            }
+            engines.push_back(*it);
+        }
+    }
+    else
+    {
+        engines = all_engines;
+    }
+
+    if (!RunGraphBenchmarks(vertex_count, queries_count) || !RunEngineBenchmarks(stops_count, queries_count, engines))
+    {
+        return 1;
+    }
+}
@@ -0,0 +1,265 @@
+#include "alloc_counter.h"
+#include "city_generator.h"
+#include "../transport-catalogue/json_builder.h"
+#include "../transport-catalogue/json_reader.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct JsonSample
+    {
+        std::string name;
+        json::Node root;
+    };
+
+    struct Measurement
+    {
+        std::vector<double> seconds;
+        size_t allocations = 0; // за один прогон
+    };
+
+    size_t CountNodes(const json::Node &node)
+    {
+        size_t count = 1;
+        if (node.IsArray())
+        {
+            for (const auto &item : node.AsArray())
+            {
+                count += CountNodes(item);
+            }
+        }
+        else if (node.IsMap())
+        {
+            for (const auto &[key, value] : node.AsMap())
+            {
+                count += CountNodes(value);
+            }
+        }
+        return count;
+    }
+
+    // Тот же документ через json::Builder
+    void BuildNode(json::Builder &builder, const json::Node &node)
+    {
+        if (node.IsArray())
+        {
+            builder.StartArray();
+            for (const auto &item : node.AsArray())
+            {
+                BuildNode(builder, item);
+            }
+            builder.EndArray();
+        }
+        else if (node.IsMap())
+        {
+            builder.StartDict();
+            for (const auto &[key, value] : node.AsMap())
+            {
+                builder.Key(key);
+                BuildNode(builder, value);
+            }
+            builder.EndDict();
+        }
+        else
+        {
+            builder.Value(node.GetValue());
+        }
+    }
+
+    // Вложенные словари и массивы глубины depth, copies штук в корневом массиве
+    json::Node MakeDeepNesting(size_t depth, size_t copies)
+    {
+        json::Array root;
+        for (size_t copy = 0; copy < copies; ++copy)
+        {
+            json::Node node = static_cast<int>(copy);
+            for (size_t level = 0; level < depth; ++level)
+            {
+                node = level % 2 ? json::Node(json::Array{std::move(node), static_cast<int>(level)}) : json::Node(json::Dict{{"level", static_cast<int>(level)}, {"next", std::move(node)}});
+            }
+            root.push_back(std::move(node));
+        }
+        return root;
+    }
+
+    // Длинные строки, в которых много символов с экранированием
+    json::Node MakeLongStrings(size_t count, size_t length)
+    {
+        const std::string pattern = "Stop \"Central\" \\ line\n\ttab\rreturn and plain text ";
+        json::Array root;
+        for (size_t index = 0; index < count; ++index)
+        {
+            std::string text;
+            text.reserve(length);
+            while (text.size() < length)
+            {
+                text += pattern;
+            }
+            text.resize(length);
+            root.push_back(json::Dict{{"id", static_cast<int>(index)}, {"text", std::move(text)}});
+        }
+        return root;
+    }
+
+    // Массивы чисел: целые, отрицательные, дробные и с порядком
+    json::Node MakeNumberArrays(size_t rows, size_t columns)
+    {
+        bench::CityRandom random(3);
+        json::Array root;
+        for (size_t row = 0; row < rows; ++row)
+        {
+            json::Array values;
+            for (size_t column = 0; column < columns; ++column)
+            {
+                switch (random.Index(4))
+                {
+                case 0:
+                    values.push_back(static_cast<int>(random.Index(1000000)));
+                    break;
+                case 1:
+                    values.push_back(-static_cast<int>(random.Index(1000)));
+                    break;
+                case 2:
+                    values.push_back(random.Real() * 1000.0);
+                    break;
+                default:
+                    values.push_back((random.Real() - 0.5) * 1e-7);
+                    break;
+                }
+            }
+            root.push_back(std::move(values));
+        }
+        return root;
+    }
+
+    template <typename Func>
+    Measurement Measure(size_t repeats, Func func)
+    {
+        Measurement measurement;
+        for (size_t repeat = 0; repeat < repeats; ++repeat)
+        {
+            const size_t allocations_before = bench::GetAllocationsCount();
+            measurement.seconds.push_back(bench::MeasureSeconds(func));
+            measurement.allocations = bench::GetAllocationsCount() - allocations_before;
+        }
+        return measurement;
+    }
+
+    void PrintRow(const std::string &sample, const std::string &operation, size_t bytes, size_t nodes, const Measurement &measurement)
+    {
+        const double median = bench::Median(measurement.seconds);
+        std::cout << sample << '\t' << operation << '\t' << bytes << '\t' << nodes << '\t' << bench::Percentile(measurement.seconds, 0.5) * 1e3 << '\t'
+                  << bench::Percentile(measurement.seconds, 0.99) * 1e3 << '\t' << static_cast<double>(bytes) / median / (1 << 20) << '\t'
+                  << static_cast<double>(measurement.allocations) / static_cast<double>(nodes) << std::endl;
+    }
+
+    // Карта города из stops_count остановок: svg::Document собирается так же, как в MapRenderer::DrawMap
+    void RunSvgSample(size_t stops_count, size_t repeats)
+    {
+        bench::CitySettings settings;
+        settings.stops_count = stops_count;
+        settings.buses_count = std::max<size_t>(1, stops_count * 3 / 20);
+        settings.requests_count = 0;
+        const json::Dict city = bench::MakeCity(settings);
+        guide::TransportCatalogue catalogue;
+        guide::FormTransportBase(city.at("base_requests").AsArray(), catalogue);
+        map_renderer::MapRenderer renderer;
+        guide::SetRenderSettings(city.at("render_settings").AsMap(), renderer);
+
+        const auto coordinates = catalogue.GetCoordinates();
+        const map_renderer::SphereProjector projector{coordinates.begin(), coordinates.end(), renderer.GetWidth(), renderer.GetHeight(), renderer.GetPadding()};
+        svg::Document document;
+        renderer.DrawLines(document, projector, catalogue);
+        renderer.DrawBusNames(document, projector, catalogue);
+        renderer.DrawStops(document, projector, catalogue);
+        renderer.DrawStopNames(document, projector, catalogue);
+
+        std::string rendered;
+        const Measurement render = Measure(repeats, [&]
+                                           {
+            std::ostringstream output;
+            document.Render(output);
+            rendered = output.str(); });
+        // Элементы — открывающие теги без заголовка <?xml и корневого <svg>
+        const size_t tags = static_cast<size_t>(std::count(rendered.begin(), rendered.end(), '<'));
+        size_t closing_tags = 0;
+        for (size_t position = rendered.find("</"); position != std::string::npos; position = rendered.find("</", position + 2))
+        {
+            ++closing_tags;
+        }
+        const size_t elements = tags - closing_tags - 2;
+        const std::string name = "map_" + std::to_string(stops_count);
+        PrintRow(name, "svg_render", rendered.size(), elements, render);
+
+        const Measurement draw = Measure(repeats, [&]
+                                         {
+            std::ostringstream output;
+            renderer.DrawMap(output, catalogue); });
+        PrintRow(name, "draw_map", rendered.size(), elements, draw);
+    }
+}
+
+// Пропускная способность json::Load, json::Print, json::Builder и svg::Document::Render на постоянном наборе документов:
+// глубокая вложенность, длинные строки с экранированием, массивы чисел, вход справочника и карты городов city_generator.
+// Для каждого документа и операции — p50/p99 времени одного документа, МБ/с по медиане (байты текста JSON или SVG)
+// и число выделений памяти на узел JSON или элемент SVG (замена operator new из alloc_counter.h).
+// Запуск: serialization_benchmark [повторов] [остановок на карте через запятую]
+int main(int argc, char *argv[])
+{
+    const size_t repeats = argc > 1 ? std::stoul(argv[1]) : 20;
+    std::vector<size_t> map_sizes;
+    {
+        std::istringstream input(argc > 2 ? argv[2] : "300,1000");
+        std::string item;
+        while (std::getline(input, item, ','))
+        {
+            map_sizes.push_back(std::stoul(item));
+        }
+    }
+
+    bench::CitySettings city;
+    city.mix = {0.2, 0.2, 0.5, 0.005, 0.02, 0.075};
+    std::vector<JsonSample> samples;
+    samples.push_back({"deep_nesting", MakeDeepNesting(400, 50)});
+    samples.push_back({"long_strings", MakeLongStrings(200, 10000)});
+    samples.push_back({"number_arrays", MakeNumberArrays(100, 1000)});
+    samples.push_back({"catalogue_input", bench::MakeCity(city)});
+
+    std::cout << "sample\toperation\tbytes\tnodes\tp50_ms\tp99_ms\tmb_per_s\tallocations_per_node" << std::endl;
+    for (const auto &sample : samples)
+    {
+        const json::Document document(sample.root);
+        std::ostringstream printed;
+        json::Print(document, printed);
+        const std::string text = printed.str();
+        const size_t nodes = CountNodes(sample.root);
+
+        const Measurement load = Measure(repeats, [&]
+                                         {
+            std::istringstream input(text);
+            const json::Document loaded = json::Load(input); });
+        PrintRow(sample.name, "json_load", text.size(), nodes, load);
+
+        const Measurement print = Measure(repeats, [&]
+                                          {
+            std::ostringstream output;
+            json::Print(document, output); });
+        PrintRow(sample.name, "json_print", text.size(), nodes, print);
+
+        const Measurement build = Measure(repeats, [&]
+                                          {
+            json::Builder builder;
+            BuildNode(builder, sample.root);
+            const json::Node built = builder.Build(); });
+        PrintRow(sample.name, "json_builder", text.size(), nodes, build);
+    }
+    for (const size_t stops_count : map_sizes)
+    {
+        RunSvgSample(stops_count, repeats);
+    }
+}
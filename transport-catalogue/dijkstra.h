@@ -0,0 +1,423 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph
+{
+    // Счётчики работы одного поиска
+    struct SearchStats
+    {
+        size_t settled_vertices = 0;
+        size_t relaxed_edges = 0;
+    };
+
+    // Дерево кратчайших путей из одной вершины. Буферы переиспользуются между поисками
+    // и не очищаются целиком: вершина считается достигнутой, только если её метка совпадает
+    // с номером текущего поиска, поэтому стоимость поиска пропорциональна просмотренной части графа.
+    template <typename Weight>
+    class Dijkstra
+    {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        explicit Dijkstra(const Graph &graph);
+
+        // Полное дерево кратчайших путей из from
+        void BuildTree(VertexId from);
+
+        // Поиск останавливается, как только найдены кратчайшие пути до всех targets
+        void BuildTree(VertexId from, const std::vector<VertexId> &targets);
+
+        // Только вершины, кратчайший путь до которых не длиннее max_weight
+        void BuildBoundedTree(VertexId from, Weight max_weight);
+
+        // Целенаправленный поиск (A*): вершины извлекаются по весу плюс potential(vertex) — нижней оценке
+        // расстояния до target. Оценка должна быть согласованной: potential(u) <= w(u, v) + potential(v).
+        // Поиск останавливается, когда найден кратчайший путь до target.
+        template <typename Potential>
+        void BuildTreeToTarget(VertexId from, VertexId target, Potential potential);
+
+        // Двунаправленный поиск: встречные волны из from по исходящим рёбрам и из target по входящим,
+        // на каждом шаге продвигается волна с меньшей очередью. Поиск останавливается, когда сумма
+        // минимальных весов в очередях не меньше лучшего найденного пути. После поиска GetWeight
+        // и BuildRoute отвечают для target; волна из target в GetSettledVertices не попадает.
+        void BuildBidirectionalTree(VertexId from, VertexId target);
+
+        bool IsSettled(VertexId vertex) const;
+        std::optional<Weight> GetWeight(VertexId to) const;
+        std::optional<typename Router<Weight>::RouteInfo> BuildRoute(VertexId to) const;
+
+        // Вершины с найденным кратчайшим путём в порядке неубывания расстояния
+        const std::vector<VertexId> &GetSettledVertices() const;
+        const SearchStats &GetStats() const;
+
+    private:
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+
+        using QueueItem = std::pair<Weight, VertexId>;
+
+        template <typename SettlePredicate, typename Potential>
+        void Search(VertexId from, SettlePredicate on_settle, Potential potential);
+
+        static Weight ZeroPotential(VertexId)
+        {
+            return ZERO_WEIGHT;
+        }
+
+        void StartSearch(VertexId from, Weight from_potential);
+
+        const Graph &graph_;
+        std::vector<Weight> weights_;
+        std::vector<Weight> potentials_;
+        std::vector<EdgeId> prev_edges_;
+        std::vector<uint32_t> reached_marks_;
+        std::vector<uint32_t> settled_marks_;
+        uint32_t mark_ = 0;
+        std::vector<QueueItem> queue_;
+        std::vector<VertexId> settled_;
+        std::vector<uint32_t> target_marks_;
+        uint32_t target_mark_ = 0;
+        SearchStats stats_;
+        // Обратная волна двунаправленного поиска: веса путей до target и первые рёбра этих путей.
+        // Буферы выделяются при первом двунаправленном поиске
+        std::vector<Weight> backward_weights_;
+        std::vector<EdgeId> backward_next_edges_;
+        std::vector<uint32_t> backward_reached_marks_;
+        std::vector<uint32_t> backward_settled_marks_;
+        std::vector<QueueItem> backward_queue_;
+    };
+
+    template <typename Weight>
+    Dijkstra<Weight>::Dijkstra(const Graph &graph)
+        : graph_(graph),
+          weights_(graph.GetVertexCount()),
+          potentials_(graph.GetVertexCount()),
+          prev_edges_(graph.GetVertexCount(), NO_EDGE),
+          reached_marks_(graph.GetVertexCount(), 0),
+          settled_marks_(graph.GetVertexCount(), 0),
+          target_marks_(graph.GetVertexCount(), 0)
+    {
+    }
+
+    template <typename Weight>
+    void Dijkstra<Weight>::StartSearch(VertexId from, Weight from_potential)
+    {
+        if (from >= graph_.GetVertexCount())
+        {
+            throw std::out_of_range("Vertex is out of graph");
+        }
+        if (++mark_ == 0)
+        {
+            // Счётчик поисков переполнился: метки прошлых поисков могут совпасть с новыми
+            std::fill(reached_marks_.begin(), reached_marks_.end(), 0);
+            std::fill(settled_marks_.begin(), settled_marks_.end(), 0);
+            std::fill(backward_reached_marks_.begin(), backward_reached_marks_.end(), 0);
+            std::fill(backward_settled_marks_.begin(), backward_settled_marks_.end(), 0);
+            mark_ = 1;
+        }
+        queue_.clear();
+        settled_.clear();
+        stats_ = {};
+        weights_[from] = ZERO_WEIGHT;
+        potentials_[from] = from_potential;
+        prev_edges_[from] = NO_EDGE;
+        reached_marks_[from] = mark_;
+        queue_.push_back({from_potential, from});
+    }
+
+    template <typename Weight>
+    template <typename SettlePredicate, typename Potential>
+    void Dijkstra<Weight>::Search(VertexId from, SettlePredicate on_settle, Potential potential)
+    {
+        StartSearch(from, potential(from));
+        const auto greater = std::greater<QueueItem>{};
+        while (!queue_.empty())
+        {
+            std::pop_heap(queue_.begin(), queue_.end(), greater);
+            const auto [key, vertex] = queue_.back();
+            queue_.pop_back();
+            // Устаревшая запись очереди: вершину уже достигли короче
+            if (settled_marks_[vertex] == mark_ || weights_[vertex] + potentials_[vertex] < key)
+            {
+                continue;
+            }
+            const Weight weight = weights_[vertex];
+            // on_settle решает, принимать ли вершину и продолжать ли поиск
+            if (!on_settle(vertex, weight))
+            {
+                break;
+            }
+            settled_marks_[vertex] = mark_;
+            settled_.push_back(vertex);
+            ++stats_.settled_vertices;
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex))
+            {
+                const auto &edge = graph_.GetEdge(edge_id);
+                if (edge.weight < ZERO_WEIGHT)
+                {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                ++stats_.relaxed_edges;
+                const Weight candidate = weight + edge.weight;
+                if (reached_marks_[edge.to] != mark_)
+                {
+                    reached_marks_[edge.to] = mark_;
+                    potentials_[edge.to] = potential(edge.to);
+                }
+                else if (!(candidate < weights_[edge.to]))
+                {
+                    continue;
+                }
+                weights_[edge.to] = candidate;
+                prev_edges_[edge.to] = edge_id;
+                queue_.push_back({candidate + potentials_[edge.to], edge.to});
+                std::push_heap(queue_.begin(), queue_.end(), greater);
+            }
+        }
+    }
+
+    template <typename Weight>
+    void Dijkstra<Weight>::BuildTree(VertexId from)
+    {
+        Search(
+            from, [](VertexId, Weight)
+            { return true; },
+            ZeroPotential);
+    }
+
+    template <typename Weight>
+    void Dijkstra<Weight>::BuildTree(VertexId from, const std::vector<VertexId> &targets)
+    {
+        if (++target_mark_ == 0)
+        {
+            std::fill(target_marks_.begin(), target_marks_.end(), 0);
+            target_mark_ = 1;
+        }
+        size_t targets_left = 0;
+        for (const VertexId target : targets)
+        {
+            if (target_marks_.at(target) != target_mark_)
+            {
+                target_marks_[target] = target_mark_;
+                ++targets_left;
+            }
+        }
+        Search(from, [&](VertexId vertex, Weight)
+               {
+                   if (targets_left == 0)
+                   {
+                       return false;
+                   }
+                   if (target_marks_[vertex] == target_mark_)
+                   {
+                       --targets_left;
+                   }
+                   return true; },
+               ZeroPotential);
+    }
+
+    template <typename Weight>
+    void Dijkstra<Weight>::BuildBoundedTree(VertexId from, Weight max_weight)
+    {
+        Search(
+            from, [max_weight](VertexId, Weight weight)
+            { return !(max_weight < weight); },
+            ZeroPotential);
+    }
+
+    template <typename Weight>
+    template <typename Potential>
+    void Dijkstra<Weight>::BuildTreeToTarget(VertexId from, VertexId target, Potential potential)
+    {
+        if (target >= graph_.GetVertexCount())
+        {
+            throw std::out_of_range("Vertex is out of graph");
+        }
+        bool target_settled = false;
+        Search(
+            from, [target, &target_settled](VertexId vertex, Weight)
+            {
+                if (target_settled)
+                {
+                    return false;
+                }
+                target_settled = vertex == target;
+                return true; },
+            potential);
+    }
+
+    template <typename Weight>
+    void Dijkstra<Weight>::BuildBidirectionalTree(VertexId from, VertexId target)
+    {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (target >= vertex_count)
+        {
+            throw std::out_of_range("Vertex is out of graph");
+        }
+        if (backward_weights_.size() != vertex_count)
+        {
+            backward_weights_.assign(vertex_count, ZERO_WEIGHT);
+            backward_next_edges_.assign(vertex_count, NO_EDGE);
+            backward_reached_marks_.assign(vertex_count, 0);
+            backward_settled_marks_.assign(vertex_count, 0);
+        }
+        StartSearch(from, ZERO_WEIGHT);
+        backward_queue_.clear();
+        backward_weights_[target] = ZERO_WEIGHT;
+        backward_next_edges_[target] = NO_EDGE;
+        backward_reached_marks_[target] = mark_;
+        backward_queue_.push_back({ZERO_WEIGHT, target});
+
+        // Лучший путь через вершину, достигнутую обеими волнами
+        std::optional<Weight> best;
+        VertexId meet = target;
+        auto update_best = [&](VertexId vertex)
+        {
+            if (reached_marks_[vertex] == mark_ && backward_reached_marks_[vertex] == mark_)
+            {
+                const Weight weight = weights_[vertex] + backward_weights_[vertex];
+                if (!best || weight < *best)
+                {
+                    best = weight;
+                    meet = vertex;
+                }
+            }
+        };
+        update_best(target);
+
+        const auto greater = std::greater<QueueItem>{};
+        auto drop_stale = [&](std::vector<QueueItem> &queue, const std::vector<Weight> &weights, const std::vector<uint32_t> &settled_marks)
+        {
+            while (!queue.empty() && (settled_marks[queue.front().second] == mark_ || weights[queue.front().second] < queue.front().first))
+            {
+                std::pop_heap(queue.begin(), queue.end(), greater);
+                queue.pop_back();
+            }
+        };
+        auto scan = [&](bool forward)
+        {
+            auto &queue = forward ? queue_ : backward_queue_;
+            auto &weights = forward ? weights_ : backward_weights_;
+            auto &edges = forward ? prev_edges_ : backward_next_edges_;
+            auto &reached_marks = forward ? reached_marks_ : backward_reached_marks_;
+            std::pop_heap(queue.begin(), queue.end(), greater);
+            const auto [weight, vertex] = queue.back();
+            queue.pop_back();
+            (forward ? settled_marks_ : backward_settled_marks_)[vertex] = mark_;
+            if (forward)
+            {
+                settled_.push_back(vertex);
+            }
+            ++stats_.settled_vertices;
+            for (const EdgeId edge_id : forward ? graph_.GetIncidentEdges(vertex) : graph_.GetIncomingEdges(vertex))
+            {
+                const auto &edge = graph_.GetEdge(edge_id);
+                if (edge.weight < ZERO_WEIGHT)
+                {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                ++stats_.relaxed_edges;
+                const VertexId next = forward ? edge.to : edge.from;
+                const Weight candidate = weight + edge.weight;
+                if (reached_marks[next] == mark_ && !(candidate < weights[next]))
+                {
+                    continue;
+                }
+                reached_marks[next] = mark_;
+                weights[next] = candidate;
+                edges[next] = edge_id;
+                queue.push_back({candidate, next});
+                std::push_heap(queue.begin(), queue.end(), greater);
+                update_best(next);
+            }
+        };
+
+        while (true)
+        {
+            drop_stale(queue_, weights_, settled_marks_);
+            drop_stale(backward_queue_, backward_weights_, backward_settled_marks_);
+            // Исчерпанная волна уже нашла кратчайшие пути до всех своих вершин, лучший путь найден
+            if (queue_.empty() || backward_queue_.empty())
+            {
+                break;
+            }
+            // Любой ещё не найденный путь не короче суммы минимальных весов в очередях
+            if (best && !(queue_.front().first + backward_queue_.front().first < *best))
+            {
+                break;
+            }
+            scan(queue_.size() <= backward_queue_.size());
+        }
+
+        if (!best)
+        {
+            return;
+        }
+        // Сшивка: путь от meet до target из обратной волны переносится в дерево прямой волны
+        settled_marks_[meet] = mark_;
+        for (EdgeId edge_id = backward_next_edges_[meet]; edge_id != NO_EDGE; edge_id = backward_next_edges_[graph_.GetEdge(edge_id).to])
+        {
+            const auto &edge = graph_.GetEdge(edge_id);
+            weights_[edge.to] = weights_[edge.from] + edge.weight;
+            prev_edges_[edge.to] = edge_id;
+            reached_marks_[edge.to] = mark_;
+            settled_marks_[edge.to] = mark_;
+        }
+    }
+
+    template <typename Weight>
+    bool Dijkstra<Weight>::IsSettled(VertexId vertex) const
+    {
+        return settled_marks_.at(vertex) == mark_;
+    }
+
+    template <typename Weight>
+    std::optional<Weight> Dijkstra<Weight>::GetWeight(VertexId to) const
+    {
+        if (!IsSettled(to))
+        {
+            return std::nullopt;
+        }
+        return weights_[to];
+    }
+
+    template <typename Weight>
+    std::optional<typename Router<Weight>::RouteInfo> Dijkstra<Weight>::BuildRoute(VertexId to) const
+    {
+        if (!IsSettled(to))
+        {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = prev_edges_[to]; edge_id != NO_EDGE; edge_id = prev_edges_[graph_.GetEdge(edge_id).from])
+        {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        return typename Router<Weight>::RouteInfo{weights_[to], std::move(edges)};
+    }
+
+    template <typename Weight>
+    const std::vector<VertexId> &Dijkstra<Weight>::GetSettledVertices() const
+    {
+        return settled_;
+    }
+
+    template <typename Weight>
+    const SearchStats &Dijkstra<Weight>::GetStats() const
+    {
+        return stats_;
+    }
+} // namespace graph
@@ -33,4 +33,10 @@ namespace guide
         int span_count;
         double time;
     };
+
+    struct ReachableStop
+    {
+        std::string_view stop_name;
+        double time;
+    };
 }
@@ -1,6 +1,7 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace guide
@@ -28,6 +29,17 @@ namespace guide
                         const double earth_radius = 6371000.0;
                         return acos(sin(from.lat * dr) * sin(to.lat * dr) + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr)) * earth_radius;
                 }
+
+                double ComputeHaversineDistance(Coordinates from, Coordinates to)
+                {
+                        using namespace std;
+                        static const double dr = M_PI / 180.0;
+                        const double earth_radius = 6371000.0;
+                        const double sin_lat = sin((to.lat - from.lat) * dr / 2.0);
+                        const double sin_lng = sin((to.lng - from.lng) * dr / 2.0);
+                        const double h = sin_lat * sin_lat + cos(from.lat * dr) * cos(to.lat * dr) * sin_lng * sin_lng;
+                        return 2.0 * asin(sqrt(min(1.0, h))) * earth_radius;
+                }
         }
 
 }
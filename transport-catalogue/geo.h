@@ -21,6 +21,9 @@ namespace guide
         };
 
         double ComputeDistance(Coordinates from, Coordinates to);
+
+        // Та же длина дуги по формуле гаверсинусов: точна и на малых расстояниях, где acos теряет точность
+        double ComputeHaversineDistance(Coordinates from, Coordinates to);
     }
 
 }
\ No newline at end of file
@@ -1,9 +1,10 @@
 #pragma once
 
+#include "memory_usage.h"
 #include "ranges.h"
-#include "transport_router.h"
 
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 #include <iostream>
 
@@ -42,6 +43,14 @@ namespace graph
         size_t GetEdgeCount() const;
         const Edge<Weight> &GetEdge(EdgeId edge_id) const;
         IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+        // Списки входящих рёбер нужны только поиску в обратную сторону, поэтому строятся по требованию;
+        // после вызова поддерживаются и при AddEdge
+        void BuildIncomingEdges();
+        bool HasIncomingEdges() const;
+        // Рёбра, входящие в vertex; до BuildIncomingEdges — std::logic_error
+        IncidentEdgesRange GetIncomingEdges(VertexId vertex) const;
+        // Рёбра и списки смежности (входящих — если построены)
+        memory::MemoryUsage GetMemoryUsage() const;
 
         void Print()
         {
@@ -54,6 +63,8 @@ namespace graph
     private:
         std::vector<Edge<Weight>> edges_;
         std::vector<IncidenceList> incidence_lists_;
+        std::vector<IncidenceList> reverse_incidence_lists_; // пусто до BuildIncomingEdges
+        bool has_incoming_edges_ = false;
     };
 
     template <typename Weight>
@@ -68,9 +79,34 @@ namespace graph
         edges_.push_back(edge);
         const EdgeId id = edges_.size() - 1;
         incidence_lists_.at(edge.from).push_back(id);
+        if (has_incoming_edges_)
+        {
+            reverse_incidence_lists_.at(edge.to).push_back(id);
+        }
         return id;
     }
 
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::BuildIncomingEdges()
+    {
+        if (has_incoming_edges_)
+        {
+            return;
+        }
+        reverse_incidence_lists_.assign(incidence_lists_.size(), {});
+        for (EdgeId id = 0; id < edges_.size(); ++id)
+        {
+            reverse_incidence_lists_[edges_[id].to].push_back(id);
+        }
+        has_incoming_edges_ = true;
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::HasIncomingEdges() const
+    {
+        return has_incoming_edges_;
+    }
+
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetVertexCount() const
     {
@@ -95,4 +131,30 @@ namespace graph
     {
         return ranges::AsRange(incidence_lists_.at(vertex));
     }
+
+    template <typename Weight>
+    typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
+    DirectedWeightedGraph<Weight>::GetIncomingEdges(VertexId vertex) const
+    {
+        if (!has_incoming_edges_)
+        {
+            throw std::logic_error("Incoming edges are not built");
+        }
+        return ranges::AsRange(reverse_incidence_lists_.at(vertex));
+    }
+
+    template <typename Weight>
+    memory::MemoryUsage DirectedWeightedGraph<Weight>::GetMemoryUsage() const
+    {
+        memory::MemoryUsage usage = memory::GetVectorUsage(edges_);
+        for (const auto *lists : {&incidence_lists_, &reverse_incidence_lists_})
+        {
+            usage += memory::GetVectorUsage(*lists);
+            for (const auto &list : *lists)
+            {
+                usage += memory::GetVectorUsage(list);
+            }
+        }
+        return usage;
+    }
 } // namespace graph
\ No newline at end of file
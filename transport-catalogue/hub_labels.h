@@ -0,0 +1,461 @@
+#pragma once
+
+#include "graph.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph
+{
+    // Размеры меток хабов
+    struct HubLabelsStats
+    {
+        size_t vertex_count = 0;
+        size_t out_entries = 0; // записей в метках «из вершины»
+        size_t in_entries = 0;  // записей в метках «в вершину»
+        size_t max_label_size = 0;
+        double average_label_size = 0.0; // в среднем на вершину и направление
+        size_t memory_bytes = 0;
+    };
+
+    // Метки хабов, построенные алгоритмом pruned landmark labeling. Вершины перебираются
+    // в порядке убывания степени (остановки многих маршрутов — первыми), и из каждой запускаются
+    // прямой и обратный поиски Дейкстры.
+    // Вершина, расстояние до которой уже покрывают метки прошлых хабов, отсекается вместе со своим поддеревом.
+    // Расстояние from -> to — минимум по общим хабам меток из from и в to; метки отсортированы по рангу хаба,
+    // поэтому запрос — слияние двух отсортированных массивов. Каждая запись хранит ребро в сторону хаба,
+    // так что путь восстанавливается по меткам без поиска.
+    template <typename Weight>
+    class HubLabels
+    {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        explicit HubLabels(const Graph &graph);
+
+        // Метки, ранее сохранённые через Save для того же графа; nullopt, если данные повреждены
+        // или построены для другого графа (сверяется контрольная сумма рёбер)
+        static std::optional<HubLabels> Load(const Graph &graph, std::istream &input);
+
+        void Save(std::ostream &output) const;
+
+        std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+        std::optional<typename Router<Weight>::RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+        HubLabelsStats GetStats() const;
+
+    private:
+        using Rank = uint32_t;
+        using LabelEdge = uint32_t;
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr LabelEdge NO_EDGE = std::numeric_limits<LabelEdge>::max();
+        static constexpr Weight NO_ROUTE = std::numeric_limits<Weight>::has_infinity ? std::numeric_limits<Weight>::infinity() : std::numeric_limits<Weight>::max();
+        static constexpr uint32_t FORMAT_VERSION = 1;
+
+        // Контрольная сумма FNV-1a по концам и весам всех рёбер
+        static uint64_t ComputeGraphChecksum(const Graph &graph);
+
+        struct LabelEntry
+        {
+            Rank hub;
+            LabelEdge edge; // для меток «из» — первое ребро пути к хабу, для меток «в» — последнее ребро пути от хаба
+            Weight weight;
+        };
+
+        // Метки всех вершин одного направления подряд в одном массиве
+        struct Labels
+        {
+            std::vector<size_t> offsets; // метка вершины v — entries[offsets[v], offsets[v + 1])
+            std::vector<LabelEntry> entries;
+
+            const LabelEntry *begin(VertexId vertex) const
+            {
+                return entries.data() + offsets[vertex];
+            }
+            const LabelEntry *end(VertexId vertex) const
+            {
+                return entries.data() + offsets[vertex + 1];
+            }
+            const LabelEntry &Find(VertexId vertex, Rank hub) const;
+        };
+
+        HubLabels(const Graph &graph, std::vector<VertexId> vertices_by_rank, Labels out_labels, Labels in_labels)
+            : graph_(graph),
+              vertices_by_rank_(std::move(vertices_by_rank)),
+              out_labels_(std::move(out_labels)),
+              in_labels_(std::move(in_labels))
+        {
+        }
+
+        // Лучший общий хаб меток from и to: вес пути и ранг хаба
+        std::optional<std::pair<Weight, Rank>> FindBestHub(VertexId from, VertexId to) const;
+
+        void Build();
+
+        const Graph &graph_;
+        std::vector<VertexId> vertices_by_rank_;
+        Labels out_labels_;
+        Labels in_labels_;
+    };
+
+    template <typename Weight>
+    HubLabels<Weight>::HubLabels(const Graph &graph)
+        : graph_(graph)
+    {
+        Build();
+    }
+
+    template <typename Weight>
+    void HubLabels<Weight>::Build()
+    {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (graph_.GetEdgeCount() >= NO_EDGE || vertex_count >= std::numeric_limits<Rank>::max())
+        {
+            throw std::length_error("Too many edges for hub labels");
+        }
+
+        vertices_by_rank_.resize(vertex_count);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+        {
+            vertices_by_rank_[vertex] = vertex;
+        }
+        auto degree = [this](VertexId vertex)
+        {
+            return graph_.GetIncidentEdges(vertex).end() - graph_.GetIncidentEdges(vertex).begin() + graph_.GetIncomingEdges(vertex).end() - graph_.GetIncomingEdges(vertex).begin();
+        };
+        std::stable_sort(vertices_by_rank_.begin(), vertices_by_rank_.end(), [&degree](VertexId lhs, VertexId rhs)
+                         { return degree(lhs) > degree(rhs); });
+
+        // На время построения метки растут по отдельности, затем укладываются подряд
+        std::vector<std::vector<LabelEntry>> out_labels(vertex_count);
+        std::vector<std::vector<LabelEntry>> in_labels(vertex_count);
+        std::vector<Weight> hub_weights(vertex_count, NO_ROUTE); // метка текущего хаба по рангам
+        std::vector<Weight> weights(vertex_count, NO_ROUTE);
+        std::vector<LabelEdge> edges(vertex_count, NO_EDGE);
+        std::vector<VertexId> reached;
+        std::vector<std::pair<Weight, VertexId>> queue;
+        const auto greater = std::greater<std::pair<Weight, VertexId>>{};
+
+        // Поиск из хаба с отсечением: forward — по исходящим рёбрам, пополняет метки «в»
+        auto pruned_search = [&](Rank rank, bool forward)
+        {
+            const VertexId hub = vertices_by_rank_[rank];
+            auto &hub_label = forward ? out_labels[hub] : in_labels[hub];
+            auto &labels = forward ? in_labels : out_labels;
+            for (const auto &entry : hub_label)
+            {
+                hub_weights[entry.hub] = entry.weight;
+            }
+            weights[hub] = ZERO_WEIGHT;
+            edges[hub] = NO_EDGE;
+            reached.push_back(hub);
+            queue.push_back({ZERO_WEIGHT, hub});
+            while (!queue.empty())
+            {
+                std::pop_heap(queue.begin(), queue.end(), greater);
+                const auto [weight, vertex] = queue.back();
+                queue.pop_back();
+                if (weights[vertex] < weight)
+                {
+                    continue;
+                }
+                // Отсечение: расстояние уже покрыто хабами с меньшим рангом
+                bool covered = false;
+                for (const auto &entry : labels[vertex])
+                {
+                    if (hub_weights[entry.hub] != NO_ROUTE && !(weight < hub_weights[entry.hub] + entry.weight))
+                    {
+                        covered = true;
+                        break;
+                    }
+                }
+                if (covered)
+                {
+                    continue;
+                }
+                labels[vertex].push_back({rank, edges[vertex], weight});
+                for (const EdgeId edge_id : forward ? graph_.GetIncidentEdges(vertex) : graph_.GetIncomingEdges(vertex))
+                {
+                    const auto &edge = graph_.GetEdge(edge_id);
+                    if (edge.weight < ZERO_WEIGHT)
+                    {
+                        throw std::domain_error("Edges' weights should be non-negative");
+                    }
+                    const VertexId next = forward ? edge.to : edge.from;
+                    const Weight candidate = weight + edge.weight;
+                    if (weights[next] == NO_ROUTE)
+                    {
+                        reached.push_back(next);
+                    }
+                    else if (!(candidate < weights[next]))
+                    {
+                        continue;
+                    }
+                    weights[next] = candidate;
+                    edges[next] = static_cast<LabelEdge>(edge_id);
+                    queue.push_back({candidate, next});
+                    std::push_heap(queue.begin(), queue.end(), greater);
+                }
+            }
+            for (const VertexId vertex : reached)
+            {
+                weights[vertex] = NO_ROUTE;
+            }
+            reached.clear();
+            for (const auto &entry : hub_label)
+            {
+                hub_weights[entry.hub] = NO_ROUTE;
+            }
+        };
+
+        for (Rank rank = 0; rank < vertex_count; ++rank)
+        {
+            pruned_search(rank, true);
+            pruned_search(rank, false);
+        }
+
+        auto flatten = [vertex_count](std::vector<std::vector<LabelEntry>> &source, Labels &labels)
+        {
+            labels.offsets.assign(vertex_count + 1, 0);
+            for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+            {
+                labels.offsets[vertex + 1] = labels.offsets[vertex] + source[vertex].size();
+            }
+            labels.entries.clear();
+            labels.entries.reserve(labels.offsets.back());
+            for (auto &label : source)
+            {
+                labels.entries.insert(labels.entries.end(), label.begin(), label.end());
+                std::vector<LabelEntry>().swap(label);
+            }
+        };
+        flatten(out_labels, out_labels_);
+        flatten(in_labels, in_labels_);
+    }
+
+    template <typename Weight>
+    const typename HubLabels<Weight>::LabelEntry &HubLabels<Weight>::Labels::Find(VertexId vertex, Rank hub) const
+    {
+        const auto it = std::lower_bound(begin(vertex), end(vertex), hub, [](const LabelEntry &entry, Rank rank)
+                                         { return entry.hub < rank; });
+        if (it == end(vertex) || it->hub != hub)
+        {
+            throw std::logic_error("Hub labels are inconsistent");
+        }
+        return *it;
+    }
+
+    template <typename Weight>
+    std::optional<std::pair<Weight, typename HubLabels<Weight>::Rank>> HubLabels<Weight>::FindBestHub(VertexId from, VertexId to) const
+    {
+        if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount())
+        {
+            throw std::out_of_range("Vertex is out of graph");
+        }
+        std::optional<std::pair<Weight, Rank>> best;
+        const LabelEntry *out = out_labels_.begin(from);
+        const LabelEntry *out_end = out_labels_.end(from);
+        const LabelEntry *in = in_labels_.begin(to);
+        const LabelEntry *in_end = in_labels_.end(to);
+        while (out != out_end && in != in_end)
+        {
+            if (out->hub < in->hub)
+            {
+                ++out;
+            }
+            else if (in->hub < out->hub)
+            {
+                ++in;
+            }
+            else
+            {
+                const Weight weight = out->weight + in->weight;
+                if (!best || weight < best->first)
+                {
+                    best = std::make_pair(weight, out->hub);
+                }
+                ++out;
+                ++in;
+            }
+        }
+        return best;
+    }
+
+    template <typename Weight>
+    std::optional<Weight> HubLabels<Weight>::GetRouteWeight(VertexId from, VertexId to) const
+    {
+        const auto best = FindBestHub(from, to);
+        if (!best)
+        {
+            return std::nullopt;
+        }
+        return best->first;
+    }
+
+    template <typename Weight>
+    std::optional<typename Router<Weight>::RouteInfo> HubLabels<Weight>::BuildRoute(VertexId from, VertexId to) const
+    {
+        const auto best = FindBestHub(from, to);
+        if (!best)
+        {
+            return std::nullopt;
+        }
+        const Rank hub = best->second;
+        std::vector<EdgeId> edges;
+        // От from к хабу по первым рёбрам меток «из»
+        for (LabelEdge edge = out_labels_.Find(from, hub).edge; edge != NO_EDGE; edge = out_labels_.Find(graph_.GetEdge(edge).to, hub).edge)
+        {
+            edges.push_back(edge);
+        }
+        // От to назад к хабу по последним рёбрам меток «в»
+        const size_t hub_part = edges.size();
+        for (LabelEdge edge = in_labels_.Find(to, hub).edge; edge != NO_EDGE; edge = in_labels_.Find(graph_.GetEdge(edge).from, hub).edge)
+        {
+            edges.push_back(edge);
+        }
+        std::reverse(edges.begin() + hub_part, edges.end());
+        return typename Router<Weight>::RouteInfo{best->first, std::move(edges)};
+    }
+
+    template <typename Weight>
+    HubLabelsStats HubLabels<Weight>::GetStats() const
+    {
+        HubLabelsStats stats;
+        stats.vertex_count = graph_.GetVertexCount();
+        stats.out_entries = out_labels_.entries.size();
+        stats.in_entries = in_labels_.entries.size();
+        for (VertexId vertex = 0; vertex < stats.vertex_count; ++vertex)
+        {
+            stats.max_label_size = std::max<size_t>({stats.max_label_size, out_labels_.offsets[vertex + 1] - out_labels_.offsets[vertex], in_labels_.offsets[vertex + 1] - in_labels_.offsets[vertex]});
+        }
+        if (stats.vertex_count > 0)
+        {
+            stats.average_label_size = static_cast<double>(stats.out_entries + stats.in_entries) / static_cast<double>(2 * stats.vertex_count);
+        }
+        stats.memory_bytes = (stats.out_entries + stats.in_entries) * sizeof(LabelEntry) + 2 * (stats.vertex_count + 1) * sizeof(size_t) + vertices_by_rank_.size() * sizeof(VertexId);
+        return stats;
+    }
+
+    // Формат: версия, число вершин и рёбер графа, контрольная сумма рёбер, порядок вершин, затем метки «из» и «в»
+    // (смещения и записи). Числа пишутся в машинном представлении: файл переносим только между
+    // сборками на одной платформе.
+    namespace hub_labels_io
+    {
+        template <typename T>
+        void Write(std::ostream &output, const T &value)
+        {
+            output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        void WriteVector(std::ostream &output, const std::vector<T> &values)
+        {
+            Write<uint64_t>(output, values.size());
+            output.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+        }
+
+        template <typename T>
+        bool Read(std::istream &input, T &value)
+        {
+            return static_cast<bool>(input.read(reinterpret_cast<char *>(&value), sizeof(T)));
+        }
+
+        template <typename T>
+        bool ReadVector(std::istream &input, std::vector<T> &values, uint64_t max_size)
+        {
+            uint64_t size = 0;
+            if (!Read(input, size) || size > max_size)
+            {
+                return false;
+            }
+            values.resize(size);
+            return static_cast<bool>(input.read(reinterpret_cast<char *>(values.data()), static_cast<std::streamsize>(size * sizeof(T))));
+        }
+    }
+
+    template <typename Weight>
+    uint64_t HubLabels<Weight>::ComputeGraphChecksum(const Graph &graph)
+    {
+        uint64_t checksum = 14695981039346656037ull;
+        auto add = [&checksum](const auto &value)
+        {
+            const auto *bytes = reinterpret_cast<const unsigned char *>(&value);
+            for (size_t i = 0; i < sizeof(value); ++i)
+            {
+                checksum = (checksum ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id)
+        {
+            const auto &edge = graph.GetEdge(edge_id);
+            add(edge.from);
+            add(edge.to);
+            add(edge.weight);
+        }
+        return checksum;
+    }
+
+    template <typename Weight>
+    void HubLabels<Weight>::Save(std::ostream &output) const
+    {
+        using namespace hub_labels_io;
+        Write<uint32_t>(output, FORMAT_VERSION);
+        Write<uint64_t>(output, graph_.GetVertexCount());
+        Write<uint64_t>(output, graph_.GetEdgeCount());
+        Write<uint64_t>(output, ComputeGraphChecksum(graph_));
+        WriteVector(output, vertices_by_rank_);
+        for (const Labels *labels : {&out_labels_, &in_labels_})
+        {
+            WriteVector(output, labels->offsets);
+            WriteVector(output, labels->entries);
+        }
+    }
+
+    template <typename Weight>
+    std::optional<HubLabels<Weight>> HubLabels<Weight>::Load(const Graph &graph, std::istream &input)
+    {
+        using namespace hub_labels_io;
+        const uint64_t vertex_count = graph.GetVertexCount();
+        uint32_t version = 0;
+        uint64_t saved_vertex_count = 0;
+        uint64_t saved_edge_count = 0;
+        uint64_t saved_checksum = 0;
+        if (!Read(input, version) || version != FORMAT_VERSION || !Read(input, saved_vertex_count) || saved_vertex_count != vertex_count || !Read(input, saved_edge_count) || saved_edge_count != graph.GetEdgeCount() || !Read(input, saved_checksum) || saved_checksum != ComputeGraphChecksum(graph))
+        {
+            return std::nullopt;
+        }
+        std::vector<VertexId> vertices_by_rank;
+        Labels out_labels;
+        Labels in_labels;
+        if (!ReadVector(input, vertices_by_rank, vertex_count) || vertices_by_rank.size() != vertex_count)
+        {
+            return std::nullopt;
+        }
+        // Метка не длиннее числа вершин, поэтому записей не больше квадрата числа вершин
+        for (Labels *direction : {&out_labels, &in_labels})
+        {
+            if (!ReadVector(input, direction->offsets, vertex_count + 1) || direction->offsets.size() != vertex_count + 1 || !ReadVector(input, direction->entries, vertex_count * vertex_count) || direction->offsets.front() != 0 || direction->offsets.back() != direction->entries.size() || !std::is_sorted(direction->offsets.begin(), direction->offsets.end()))
+            {
+                return std::nullopt;
+            }
+            for (const auto &entry : direction->entries)
+            {
+                if (entry.hub >= vertex_count || (entry.edge != NO_EDGE && entry.edge >= graph.GetEdgeCount()))
+                {
+                    return std::nullopt;
+                }
+            }
+        }
+        return HubLabels(graph, std::move(vertices_by_rank), std::move(out_labels), std::move(in_labels));
+    }
+} // namespace graph
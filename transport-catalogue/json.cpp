@@ -538,4 +538,31 @@ namespace json
         // Реализуйте функцию самостоятельно
     }
 
+    memory::MemoryUsage GetMemoryUsage(const Node &node)
+    {
+        memory::MemoryUsage usage;
+        if (node.IsString())
+        {
+            usage += memory::GetStringUsage(node.AsString());
+        }
+        else if (node.IsArray())
+        {
+            usage += memory::GetVectorUsage(node.AsArray());
+            for (const auto &item : node.AsArray())
+            {
+                usage += GetMemoryUsage(item);
+            }
+        }
+        else if (node.IsMap())
+        {
+            usage += memory::GetMapUsage(node.AsMap());
+            for (const auto &[key, value] : node.AsMap())
+            {
+                usage += memory::GetStringUsage(key);
+                usage += GetMemoryUsage(value);
+            }
+        }
+        return usage;
+    }
+
 } // namespace json
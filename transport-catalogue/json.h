@@ -1,5 +1,7 @@
 #pragma once
 
+#include "memory_usage.h"
+
 #include <stdexcept>
 #include <map>
 #include <string>
@@ -81,4 +83,7 @@ namespace json
 
     void Print(const Document &doc, std::ostream &output);
 
+    // Куча, занятая потомками узла и строками; сам узел не считается
+    memory::MemoryUsage GetMemoryUsage(const Node &node);
+
 } // namespace json
\ No newline at end of file
@@ -1,14 +1,158 @@
 #include "json_reader.h"
 #include "svg.h"
 #include "request_handler.h"
+#include "tracing.h"
 
+#include <iostream>
 #include <string>
 #include <vector>
 
 namespace guide
 {
+    namespace
+    {
+        // Стадия обработки: время в сводке --stats и отрезок в трассировке --trace
+        class Stage
+        {
+        public:
+            Stage(stats::RunStats *stats, std::string_view name, size_t count = 1)
+                : timer_(stats, name, stats::CpuClock::PROCESS, count),
+                  span_(name)
+            {
+            }
+
+            void Stop()
+            {
+                span_.End();
+                timer_.Stop();
+            }
+
+        private:
+            stats::ScopedTimer timer_;
+            tracing::Span span_;
+        };
+
+        // Оценка памяти частей программы после стадии phase; transport_router и answers — nullptr, пока их нет.
+        // Обход делается вне таймеров стадий и только со сводкой --stats
+        void RecordMemory(stats::RunStats *stats, std::string_view phase, const json::Document &input, const TransportCatalogue &transport_catalogue,
+                          const router::TransportRouter *transport_router, const json::Document *answers)
+        {
+            if (!stats)
+            {
+                return;
+            }
+            stats::MemorySnapshot snapshot{std::string(phase), {}};
+            snapshot.subsystems.emplace_back("json_input", json::GetMemoryUsage(input.GetRoot()));
+            snapshot.subsystems.emplace_back("transport_catalogue", transport_catalogue.GetMemoryUsage());
+            if (transport_router)
+            {
+                for (const auto &[subsystem, usage] : transport_router->GetMemoryUsage())
+                {
+                    snapshot.subsystems.emplace_back("transport_router." + std::string(subsystem), usage);
+                }
+            }
+            if (answers)
+            {
+                snapshot.subsystems.emplace_back("json_answers", json::GetMemoryUsage(answers->GetRoot()));
+            }
+            stats->AddMemorySnapshot(std::move(snapshot));
+        }
+
+        // Способ поиска (и почему его выбрал AUTO), размеры его структур и обращения к кэшу маршрутов
+        // с профилем в сводку --stats; вызывается после ответов на запросы
+        void RecordRouting(stats::RunStats *stats, const router::TransportRouter &transport_router)
+        {
+            if (!stats)
+            {
+                return;
+            }
+            const router::RouterBuildReport report = transport_router.GetBuildReport();
+            json::Builder routing;
+            routing.StartDict().Key("engine").Value(std::string(router::GetEngineName(report.engine)));
+            if (!report.engine_selection.empty())
+            {
+                routing.Key("engine_selection").Value(report.engine_selection);
+            }
+            if (report.hub_labels)
+            {
+                const graph::HubLabelsStats &labels = *report.hub_labels;
+                routing.Key("hub_labels").StartDict().Key("source").Value(std::string(report.hub_labels_loaded ? "loaded" : "built"));
+                routing.Key("vertices").Value(static_cast<int>(labels.vertex_count)).Key("out_entries").Value(static_cast<double>(labels.out_entries));
+                routing.Key("in_entries").Value(static_cast<double>(labels.in_entries)).Key("average_label_size").Value(labels.average_label_size);
+                routing.Key("max_label_size").Value(static_cast<int>(labels.max_label_size)).Key("memory_bytes").Value(static_cast<double>(labels.memory_bytes)).EndDict();
+            }
+            if (report.overlay)
+            {
+                const graph::OverlayStats &overlay = *report.overlay;
+                routing.Key("overlay").StartDict().Key("levels").StartArray();
+                for (size_t level = 0; level < overlay.cells.size(); ++level)
+                {
+                    routing.StartDict().Key("cells").Value(static_cast<int>(overlay.cells[level])).Key("entries").Value(static_cast<int>(overlay.entries[level]));
+                    routing.Key("exits").Value(static_cast<int>(overlay.exits[level])).EndDict();
+                }
+                routing.EndArray().Key("clique_weights").Value(static_cast<double>(overlay.clique_weights)).Key("memory_bytes").Value(static_cast<double>(overlay.memory_bytes)).EndDict();
+            }
+            if (report.pareto_profiles)
+            {
+                const router::ParetoProfilesStats &profiles = *report.pareto_profiles;
+                routing.Key("pareto_profiles").StartDict().Key("pairs").Value(static_cast<double>(profiles.pairs)).Key("labels").Value(static_cast<double>(profiles.labels));
+                routing.Key("max_profile_size").Value(static_cast<int>(profiles.max_profile_size)).Key("memory_bytes").Value(static_cast<double>(profiles.memory_bytes)).EndDict();
+            }
+            const std::vector<router::ProfileCacheStats> cache_stats = transport_router.GetProfileCacheStats();
+            if (!cache_stats.empty())
+            {
+                routing.Key("profile_cache").StartArray();
+                for (const router::ProfileCacheStats &profile_stats : cache_stats)
+                {
+                    routing.StartDict().Key("bus_wait_time").Value(profile_stats.profile.bus_wait_time).Key("bus_velocity").Value(profile_stats.profile.bus_velocity);
+                    routing.Key("hits").Value(static_cast<double>(profile_stats.hits)).Key("misses").Value(static_cast<double>(profile_stats.misses));
+                    routing.Key("evictions").Value(static_cast<double>(profile_stats.evictions)).Key("entries").Value(static_cast<double>(profile_stats.entries)).EndDict();
+                }
+                routing.EndArray();
+            }
+            stats->SetRouting(routing.EndDict().Build());
+        }
+
+        // Номера всех остановок списка или nullopt, если хотя бы одна неизвестна
+        std::optional<std::vector<size_t>> FindStopIds(const json::Array &stops, const router::TransportRouter &transport_router)
+        {
+            std::vector<size_t> ids;
+            ids.reserve(stops.size());
+            for (const auto &stop : stops)
+            {
+                const auto id = transport_router.FindStopId(stop.AsString());
+                if (!id)
+                {
+                    return std::nullopt;
+                }
+                ids.push_back(*id);
+            }
+            return ids;
+        }
+
+        // Профиль Route-запроса: свои bus_wait_time и (или) bus_velocity, недостающее — из настроек маршрутизации
+        std::optional<router::RoutingProfile> ParseRouteProfile(const json::Dict &info, const router::TransportRouter &transport_router)
+        {
+            if (!info.count("bus_wait_time") && !info.count("bus_velocity"))
+            {
+                return std::nullopt;
+            }
+            router::RoutingProfile profile = transport_router.GetRoutingProfile();
+            if (info.count("bus_wait_time"))
+            {
+                profile.bus_wait_time = info.at("bus_wait_time").AsInt();
+            }
+            if (info.count("bus_velocity"))
+            {
+                profile.bus_velocity = info.at("bus_velocity").AsInt();
+            }
+            return profile;
+        }
+    }
+
     void FormTransportBase(const json::Array &base_requests, TransportCatalogue &transport_catalogue)
     {
+        tracing::Span stops_span("add_stops", "catalogue");
         for (const auto &info : base_requests)
         {
             if (info.AsMap().at("type").AsString() == "Stop")
@@ -17,6 +161,8 @@ namespace guide
                 transport_catalogue.AddStop(info.AsMap().at("name").AsString(), {info.AsMap().at("latitude").AsDouble(), info.AsMap().at("longitude").AsDouble()});
             }
         }
+        stops_span.End();
+        tracing::Span distances_span("add_distances", "catalogue");
         for (const auto &info : base_requests)
         {
             if (info.AsMap().at("type").AsString() == "Stop")
@@ -29,6 +175,8 @@ namespace guide
                 transport_catalogue.AddDistances(info.AsMap().at("name").AsString(), stop_distances);
             }
         }
+        distances_span.End();
+        tracing::Span buses_span("add_buses", "catalogue");
         for (const auto &info : base_requests)
         {
             if (info.AsMap().at("type").AsString() == "Bus")
@@ -55,28 +203,66 @@ namespace guide
         }
     }
 
-    json::Array FormRequestsAnswers(const json::Array &stat_requests, guide::RequestHandler &request_handler)
+    std::vector<StatRequest> ParseStatRequests(const json::Array &stat_requests, const TransportCatalogue &transport_catalogue, const router::TransportRouter &transport_router,
+                                               std::vector<size_t> *source_indexes)
     {
-        json::Array answers;
-        for (const auto &request : stat_requests)
+        std::vector<StatRequest> requests;
+        requests.reserve(stat_requests.size());
+        for (size_t index = 0; index < stat_requests.size(); ++index)
         {
-            if (request.AsMap().at("type").AsString() == "Bus" || request.AsMap().at("type").AsString() == "Stop")
+            const json::Dict &info = stat_requests[index].AsMap();
+            const std::string &type = info.at("type").AsString();
+            StatRequest parsed;
+            parsed.id = info.at("id").AsInt();
+            if (type == "Bus")
+            {
+                parsed.type = RequestType::BUS;
+                parsed.name = transport_catalogue.FindBus(info.at("name").AsString());
+            }
+            else if (type == "Stop")
+            {
+                parsed.type = RequestType::STOP;
+                parsed.name = transport_catalogue.FindStop(info.at("name").AsString());
+            }
+            else if (type == "Map")
+            {
+                parsed.type = RequestType::MAP;
+            }
+            else if (type == "Route")
+            {
+                parsed.type = RequestType::ROUTE;
+                parsed.from = transport_router.FindStopId(info.at("from").AsString());
+                parsed.to = transport_router.FindStopId(info.at("to").AsString());
+                parsed.profile = ParseRouteProfile(info, transport_router);
+            }
+            else if (type == "RouteMatrix")
             {
-                answers.push_back(request_handler.FormBusAndStopAnswer(request.AsMap().at("id").AsInt(), request.AsMap().at("type").AsString(), request.AsMap().at("name").AsString()));
-                // std::cout << "Form Bus ans Stop Answers is completed!" << std::endl;
+                parsed.type = RequestType::ROUTE_MATRIX;
+                parsed.origins = FindStopIds(info.at("from").AsArray(), transport_router);
+                parsed.destinations = FindStopIds(info.at("to").AsArray(), transport_router);
             }
-            else if (request.AsMap().at("type").AsString() == "Map")
+            else if (type == "Isochrone")
+            {
+                parsed.type = RequestType::ISOCHRONE;
+                parsed.from = transport_router.FindStopId(info.at("from").AsString());
+                parsed.max_time = info.at("max_time").AsDouble();
+            }
+            else
             {
-                answers.push_back(request_handler.FormMapAnswer(request.AsMap().at("id").AsInt()));
-                // std::cout << "Form Map Answers is completed!" << std::endl;
+                continue;
             }
-            else if (request.AsMap().at("type").AsString() == "Route")
+            requests.push_back(std::move(parsed));
+            if (source_indexes)
             {
-                answers.push_back(request_handler.FormRouteAnswer(request.AsMap().at("id").AsInt(), request.AsMap().at("from").AsString(), request.AsMap().at("to").AsString()));
-                // std::cout << "Form Route Answers is completed!" << std::endl;
+                source_indexes->push_back(index);
             }
         }
-        return answers;
+        return requests;
+    }
+
+    json::Array FormRequestsAnswers(const std::vector<StatRequest> &stat_requests, guide::RequestHandler &request_handler, size_t threads_count, stats::RunStats *stats, std::vector<double> *ready_times)
+    {
+        return request_handler.FormAnswers(stat_requests, threads_count, stats, ready_times);
     }
 
     svg::Color ParseColor(const json::Dict &render_settings, const std::string color_type)
@@ -117,6 +303,64 @@ namespace guide
         return svg::Color(svg::StringColor{color.AsString()});
     }
 
+    router::RoutingSettings ParseRoutingSettings(const json::Dict &routing_settings, size_t threads_count)
+    {
+        router::RoutingSettings settings;
+        settings.bus_wait_time = routing_settings.at("bus_wait_time").AsInt();
+        settings.bus_velocity = routing_settings.at("bus_velocity").AsInt();
+        settings.threads_count = threads_count;
+        if (routing_settings.count("routing_engine"))
+        {
+            static const std::map<std::string, router::RoutingEngine> engines = {
+                {"all_pairs", router::RoutingEngine::ALL_PAIRS},
+                {"all_pairs_blocked", router::RoutingEngine::ALL_PAIRS_BLOCKED},
+                {"dijkstra", router::RoutingEngine::DIJKSTRA},
+                {"astar", router::RoutingEngine::ASTAR},
+                {"alt", router::RoutingEngine::ALT},
+                {"bidirectional", router::RoutingEngine::BIDIRECTIONAL},
+                {"hub_labels", router::RoutingEngine::HUB_LABELS},
+                {"raptor", router::RoutingEngine::RAPTOR},
+                {"overlay", router::RoutingEngine::OVERLAY},
+                {"pareto_profiles", router::RoutingEngine::PARETO_PROFILES},
+                {"auto", router::RoutingEngine::AUTO}};
+            const std::string &engine = routing_settings.at("routing_engine").AsString();
+            if (!engines.count(engine))
+            {
+                throw std::invalid_argument("Unknown routing engine: " + engine);
+            }
+            settings.engine = engines.at(engine);
+        }
+        if (routing_settings.count("memory_budget_mb"))
+        {
+            settings.memory_budget_bytes = static_cast<size_t>(routing_settings.at("memory_budget_mb").AsDouble() * (1 << 20));
+        }
+        if (routing_settings.count("landmarks_count"))
+        {
+            settings.landmarks_count = static_cast<size_t>(routing_settings.at("landmarks_count").AsInt());
+        }
+        if (routing_settings.count("hub_labels_file"))
+        {
+            settings.hub_labels_file = routing_settings.at("hub_labels_file").AsString();
+        }
+        if (routing_settings.count("overlay_cell_size"))
+        {
+            settings.overlay_cell_size = static_cast<size_t>(routing_settings.at("overlay_cell_size").AsInt());
+        }
+        if (routing_settings.count("overlay_levels"))
+        {
+            settings.overlay_levels = static_cast<size_t>(routing_settings.at("overlay_levels").AsInt());
+        }
+        if (routing_settings.count("profile_cache_size"))
+        {
+            settings.profile_cache_size = static_cast<size_t>(routing_settings.at("profile_cache_size").AsInt());
+        }
+        if (routing_settings.count("preprocessing_budget_sec"))
+        {
+            settings.preprocessing_budget_seconds = routing_settings.at("preprocessing_budget_sec").AsDouble();
+        }
+        return settings;
+    }
+
     void SetRenderSettings(const json::Dict &render_settings, map_renderer::MapRenderer &map_renderer)
     {
         map_renderer::settings sett;
@@ -141,20 +385,61 @@ namespace guide
     }
 
 
-    void FormTransportBaseAndRequests(std::istream &input, TransportCatalogue &transport_catalogue, map_renderer::MapRenderer &map_renderer, std::ostream &output)
+    void FormTransportBaseAndRequests(std::istream &input, TransportCatalogue &transport_catalogue, map_renderer::MapRenderer &map_renderer, std::ostream &output, size_t threads_count, stats::RunStats *stats,
+                                      request_log::RequestLog *log)
     {
+        // Без --stats сводка стадий, памяти и маршрутизатора не собирается: запросам нужны только их задержки
+        stats::RunStats *const summary = stats && !stats->IsRequestsOnly() ? stats : nullptr;
+        Stage total_stage(summary, "total");
+        Stage load_stage(summary, "json_load");
         json::Document doc = json::Load(input);
+        load_stage.Stop();
+        RecordMemory(summary, "json_load", doc, transport_catalogue, nullptr, nullptr);
         // json::Print(doc, output);
+        Stage base_stage(summary, "form_transport_base");
         FormTransportBase(doc.GetRoot().AsMap().at("base_requests").AsArray(), transport_catalogue);
+        base_stage.Stop();
+        RecordMemory(summary, "form_transport_base", doc, transport_catalogue, nullptr, nullptr);
         // std::cerr << "Transport Base is complited!" << std::endl;
         //   transport_catalogue.GetAllInfo();
+        Stage render_stage(summary, "set_render_settings");
         SetRenderSettings(doc.GetRoot().AsMap().at("render_settings").AsMap(), map_renderer);
+        render_stage.Stop();
         // std::cerr << "Render Settings is complited!" << std::endl;
-        router::TransportRouter transport_router(doc.GetRoot().AsMap().at("routing_settings").AsMap().at("bus_wait_time").AsInt(), doc.GetRoot().AsMap().at("routing_settings").AsMap().at("bus_velocity").AsInt(), transport_catalogue);
+        const json::Dict &routing_settings = doc.GetRoot().AsMap().at("routing_settings").AsMap();
+        Stage router_stage(summary, "transport_router");
+        router::TransportRouter transport_router(ParseRoutingSettings(routing_settings, threads_count), transport_catalogue);
+        router_stage.Stop();
+        RecordMemory(summary, "transport_router", doc, transport_catalogue, &transport_router, nullptr);
         // std::cerr << "Route Base is complited!" << std::endl;
         guide::RequestHandler request_handler(transport_catalogue, map_renderer, transport_router);
-        json::Document requests(FormRequestsAnswers(doc.GetRoot().AsMap().at("stat_requests").AsArray(), request_handler));
+        Stage parse_stage(summary, "parse_stat_requests");
+        const json::Array &raw_requests = doc.GetRoot().AsMap().at("stat_requests").AsArray();
+        std::vector<size_t> source_indexes;
+        const std::vector<StatRequest> stat_requests = ParseStatRequests(raw_requests, transport_catalogue, transport_router, log ? &source_indexes : nullptr);
+        parse_stage.Stop();
+        Stage answers_stage(summary, "form_requests_answers", stat_requests.size());
+        json::Document requests(FormRequestsAnswers(stat_requests, request_handler, threads_count, stats, log ? &log->offsets : nullptr));
+        answers_stage.Stop();
+        if (log)
+        {
+            for (const char *key : {"base_requests", "render_settings", "routing_settings"})
+            {
+                log->snapshot[key] = doc.GetRoot().AsMap().at(key);
+            }
+            // Только запросы, на которые есть ответ: журнал сопоставляет запросы, времена и ответы по номеру
+            log->requests.reserve(source_indexes.size());
+            for (const size_t index : source_indexes)
+            {
+                log->requests.push_back(raw_requests[index]);
+            }
+            log->responses = requests.GetRoot().AsArray();
+        }
+        RecordMemory(summary, "form_requests_answers", doc, transport_catalogue, &transport_router, &requests);
+        RecordRouting(summary, transport_router);
         // std::cerr << "Requests Answers is complited!" << std::endl;
+        Stage print_stage(summary, "json_print");
         json::Print(requests, output);
+        print_stage.Stop();
     }
 }
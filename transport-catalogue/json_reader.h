@@ -7,6 +7,8 @@
 #include "json.h"
 #include "request_handler.h"
 #include "map_renderer.h"
+#include "request_log.h"
+#include "run_stats.h"
 #include "transport_router.h"
 
 namespace guide
@@ -31,7 +33,20 @@ namespace guide
     };
 
     void FormTransportBase(const json::Array &base_requests, TransportCatalogue &transport_catalogue);
-    json::Array FormRequestsAnswers(const json::Array &stat_requests, guide::RequestHandler &request_handler);
-    void FormTransportBaseAndRequests(std::istream &input, TransportCatalogue &transport_catalogue, map_renderer::MapRenderer &map_renderer, std::ostream &output);
+    void SetRenderSettings(const json::Dict &render_settings, map_renderer::MapRenderer &map_renderer);
+    // routing_settings.routing_engine: "all_pairs" (по умолчанию), "all_pairs_blocked", "dijkstra", "astar", "alt",
+    // "bidirectional", "hub_labels", "raptor", "overlay", "pareto_profiles" или "auto";
+    // для "auto" — бюджеты memory_budget_mb и preprocessing_budget_sec
+    router::RoutingSettings ParseRoutingSettings(const json::Dict &routing_settings, size_t threads_count);
+    // Запросы неизвестных типов пропускаются; в source_indexes — номер в stat_requests каждого разобранного запроса
+    std::vector<StatRequest> ParseStatRequests(const json::Array &stat_requests, const TransportCatalogue &transport_catalogue, const router::TransportRouter &transport_router,
+                                               std::vector<size_t> *source_indexes = nullptr);
+    // Ответы возвращаются в порядке запросов независимо от числа потоков
+    json::Array FormRequestsAnswers(const std::vector<StatRequest> &stat_requests, guide::RequestHandler &request_handler, size_t threads_count = 1, stats::RunStats *stats = nullptr, std::vector<double> *ready_times = nullptr);
+    // С stats время каждой стадии и запросов каждого типа добавляется в сводку; без неё таймеры не работают.
+    // При stats->IsRequestsOnly() собираются только задержки запросов и журнал медленных запросов.
+    // С log снимок базы, запросы, время готовности и ответы записываются в журнал для повтора
+    void FormTransportBaseAndRequests(std::istream &input, TransportCatalogue &transport_catalogue, map_renderer::MapRenderer &map_renderer, std::ostream &output, size_t threads_count = 1, stats::RunStats *stats = nullptr,
+                                      request_log::RequestLog *log = nullptr);
 
 }
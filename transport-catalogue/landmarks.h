@@ -0,0 +1,169 @@
+#pragma once
+
+#include "dijkstra.h"
+#include "graph.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace graph
+{
+    // Предподсчитанные расстояния от опорных вершин (landmarks) и до них для нижних оценок ALT:
+    // по неравенству треугольника d(v, t) >= d(L, t) - d(L, v) и d(v, t) >= d(v, L) - d(t, L).
+    // Опорные вершины выбираются по одной как самые удалённые от уже выбранных.
+    template <typename Weight>
+    class Landmarks
+    {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        Landmarks(const Graph &graph, size_t landmarks_count, size_t threads_count = 1);
+
+        // Согласованная нижняя оценка кратчайшего пути from -> to; бесконечность, если пути заведомо нет
+        Weight GetLowerBound(VertexId from, VertexId to) const;
+
+        const std::vector<VertexId> &GetLandmarks() const;
+
+        memory::MemoryUsage GetMemoryUsage() const
+        {
+            memory::MemoryUsage usage = memory::GetVectorUsage(landmarks_);
+            usage += memory::GetVectorUsage(from_landmarks_);
+            usage += memory::GetVectorUsage(to_landmarks_);
+            return usage;
+        }
+
+    private:
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr Weight NO_ROUTE = std::numeric_limits<Weight>::has_infinity ? std::numeric_limits<Weight>::infinity() : std::numeric_limits<Weight>::max();
+
+        size_t GetIndex(VertexId vertex, size_t landmark) const
+        {
+            return vertex * landmarks_.size() + landmark;
+        }
+
+        void FillDistances(const Dijkstra<Weight> &search, size_t landmark, std::vector<Weight> &distances) const;
+
+        size_t vertex_count_ = 0;
+        std::vector<VertexId> landmarks_;
+        // Матрицы vertex_count x число опорных вершин: строка вершины лежит в памяти подряд
+        std::vector<Weight> from_landmarks_;
+        std::vector<Weight> to_landmarks_;
+    };
+
+    template <typename Weight>
+    Landmarks<Weight>::Landmarks(const Graph &graph, size_t landmarks_count, size_t threads_count)
+        : vertex_count_(graph.GetVertexCount())
+    {
+        landmarks_count = std::min(landmarks_count, vertex_count_);
+        if (landmarks_count == 0)
+        {
+            return;
+        }
+
+        // Выбор опорных вершин: поиск из вершины 0 даёт первую, дальше каждая следующая —
+        // вершина с наибольшим расстоянием до ближайшей из выбранных (недостижимые — в первую очередь)
+        Dijkstra<Weight> search(graph);
+        std::vector<Weight> nearest(vertex_count_, NO_ROUTE);
+        std::vector<std::vector<Weight>> forward;
+        forward.reserve(landmarks_count);
+        VertexId next = 0;
+        search.BuildTree(next);
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex)
+        {
+            nearest[vertex] = search.GetWeight(vertex).value_or(NO_ROUTE);
+        }
+        while (landmarks_.size() < landmarks_count)
+        {
+            next = static_cast<VertexId>(std::max_element(nearest.begin(), nearest.end()) - nearest.begin());
+            if (nearest[next] == ZERO_WEIGHT && !landmarks_.empty())
+            {
+                break; // все вершины уже совпадают с опорными
+            }
+            landmarks_.push_back(next);
+            search.BuildTree(next);
+            forward.emplace_back(vertex_count_);
+            for (VertexId vertex = 0; vertex < vertex_count_; ++vertex)
+            {
+                forward.back()[vertex] = search.GetWeight(vertex).value_or(NO_ROUTE);
+                nearest[vertex] = landmarks_.size() == 1 ? forward.back()[vertex] : std::min(nearest[vertex], forward.back()[vertex]);
+            }
+        }
+
+        from_landmarks_.assign(vertex_count_ * landmarks_.size(), NO_ROUTE);
+        to_landmarks_.assign(vertex_count_ * landmarks_.size(), NO_ROUTE);
+        for (size_t landmark = 0; landmark < landmarks_.size(); ++landmark)
+        {
+            for (VertexId vertex = 0; vertex < vertex_count_; ++vertex)
+            {
+                from_landmarks_[GetIndex(vertex, landmark)] = forward[landmark][vertex];
+            }
+        }
+
+        // Расстояния до опорных вершин — поиск из них по обращённому графу, опорные вершины независимы
+        Graph reversed(vertex_count_);
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id)
+        {
+            const auto &edge = graph.GetEdge(edge_id);
+            reversed.AddEdge({edge.to, edge.from, edge.weight});
+        }
+        std::vector<std::optional<Dijkstra<Weight>>> searches(std::max<size_t>(1, threads_count));
+        parallel::ForEachIndex(landmarks_.size(), searches.size(), [&](size_t landmark, size_t thread_index)
+                               {
+                                   auto &reversed_search = searches[thread_index];
+                                   if (!reversed_search)
+                                   {
+                                       reversed_search.emplace(reversed);
+                                   }
+                                   reversed_search->BuildTree(landmarks_[landmark]);
+                                   FillDistances(*reversed_search, landmark, to_landmarks_); });
+    }
+
+    template <typename Weight>
+    void Landmarks<Weight>::FillDistances(const Dijkstra<Weight> &search, size_t landmark, std::vector<Weight> &distances) const
+    {
+        for (const VertexId vertex : search.GetSettledVertices())
+        {
+            distances[GetIndex(vertex, landmark)] = *search.GetWeight(vertex);
+        }
+    }
+
+    template <typename Weight>
+    Weight Landmarks<Weight>::GetLowerBound(VertexId from, VertexId to) const
+    {
+        Weight bound = ZERO_WEIGHT;
+        const Weight *from_row = from_landmarks_.data() + GetIndex(from, 0);
+        const Weight *to_row = from_landmarks_.data() + GetIndex(to, 0);
+        const Weight *from_back_row = to_landmarks_.data() + GetIndex(from, 0);
+        const Weight *to_back_row = to_landmarks_.data() + GetIndex(to, 0);
+        for (size_t landmark = 0; landmark < landmarks_.size(); ++landmark)
+        {
+            if (from_row[landmark] != NO_ROUTE)
+            {
+                if (to_row[landmark] == NO_ROUTE)
+                {
+                    return NO_ROUTE; // из L достижима from, но не to: значит, и из from to недостижима
+                }
+                bound = std::max(bound, to_row[landmark] - from_row[landmark]);
+            }
+            if (to_back_row[landmark] != NO_ROUTE)
+            {
+                if (from_back_row[landmark] == NO_ROUTE)
+                {
+                    return NO_ROUTE; // из to L достижима, из from — нет
+                }
+                bound = std::max(bound, from_back_row[landmark] - to_back_row[landmark]);
+            }
+        }
+        return bound;
+    }
+
+    template <typename Weight>
+    const std::vector<VertexId> &Landmarks<Weight>::GetLandmarks() const
+    {
+        return landmarks_;
+    }
+} // namespace graph
@@ -1,14 +1,179 @@
 #include "json_reader.h"
 #include "map_renderer.h"
+#include "parallel.h"
+#include "request_log.h"
+#include "run_stats.h"
+#include "tracing.h"
 
+#include <algorithm>
+#include <cctype>
 #include <clocale>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 using namespace std;
 
-int main()
+namespace
 {
+    // Число потоков из --threads=N: nullopt, если это не целое положительное число
+    optional<size_t> ParseThreadsCount(const string &text)
+    {
+        if (text.empty() || !all_of(text.begin(), text.end(), [](char c)
+                                    { return isdigit(static_cast<unsigned char>(c)) != 0; }))
+        {
+            return nullopt;
+        }
+        try
+        {
+            const unsigned long value = stoul(text);
+            return value == 0 ? nullopt : optional<size_t>(value);
+        }
+        catch (const out_of_range &)
+        {
+            return nullopt;
+        }
+    }
+
+    // Порог в миллисекундах из --slow_request_ms=T: nullopt, если это не конечное неотрицательное число
+    optional<double> ParseMilliseconds(const string &text)
+    {
+        if (text.empty() || isspace(static_cast<unsigned char>(text.front())))
+        {
+            return nullopt;
+        }
+        try
+        {
+            size_t parsed = 0;
+            const double value = stod(text, &parsed);
+            if (parsed != text.size() || !isfinite(value) || value < 0.0)
+            {
+                return nullopt;
+            }
+            return value;
+        }
+        catch (const logic_error &)
+        {
+            return nullopt;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // --threads=N задаёт число потоков для обработки stat_requests;
+    // --stats печатает в stderr сводку времени стадий в JSON, --stats=FILE — пишет её в файл;
+    // --slow_request_ms=T ведёт журнал запросов не быстрее T мс: в сводке или, без --stats, отдельно в stderr;
+    // --trace=FILE пишет отрезки стадий, слоёв карты и запросов по потокам в формате Chrome trace event;
+    // --record=FILE пишет журнал запросов со снимком базы, временем и ответами для benchmarks/request_replay
+    size_t threads_count = parallel::DefaultThreadsCount();
+    bool print_stats = false;
+    string stats_file;
+    string trace_file;
+    string record_file;
+    stats::RunStats run_stats;
+    for (int i = 1; i < argc; ++i)
+    {
+        const string_view arg = argv[i];
+        if (arg.substr(0, "--threads="sv.size()) == "--threads="sv)
+        {
+            const string value(arg.substr("--threads="sv.size()));
+            const optional<size_t> count = ParseThreadsCount(value);
+            if (!count)
+            {
+                cerr << "error: --threads expects a positive integer, got \"" << value << "\"" << endl;
+                return 1;
+            }
+            threads_count = *count;
+        }
+        else if (arg == "--stats"sv)
+        {
+            print_stats = true;
+        }
+        else if (arg.substr(0, "--stats="sv.size()) == "--stats="sv)
+        {
+            print_stats = true;
+            stats_file = string(arg.substr("--stats="sv.size()));
+        }
+        else if (arg.substr(0, "--trace="sv.size()) == "--trace="sv)
+        {
+            trace_file = string(arg.substr("--trace="sv.size()));
+        }
+        else if (arg.substr(0, "--record="sv.size()) == "--record="sv)
+        {
+            record_file = string(arg.substr("--record="sv.size()));
+        }
+        else if (arg.substr(0, "--slow_request_ms="sv.size()) == "--slow_request_ms="sv)
+        {
+            const string value(arg.substr("--slow_request_ms="sv.size()));
+            const optional<double> milliseconds = ParseMilliseconds(value);
+            if (!milliseconds)
+            {
+                cerr << "error: --slow_request_ms expects a non-negative number, got \"" << value << "\"" << endl;
+                return 1;
+            }
+            run_stats.SetSlowRequestThreshold(*milliseconds / 1000.0);
+        }
+    }
+
     guide::TransportCatalogue catalogue;
     map_renderer::MapRenderer map_renderer;
-    guide::FormTransportBaseAndRequests(cin, catalogue, map_renderer, cout);
+    if (!trace_file.empty())
+    {
+        tracing::Enable();
+    }
+    const bool collect_stats = print_stats || run_stats.GetSlowRequestThreshold();
+    run_stats.SetRequestsOnly(!print_stats);
+    request_log::RequestLog log;
+    guide::FormTransportBaseAndRequests(cin, catalogue, map_renderer, cout, threads_count, collect_stats ? &run_stats : nullptr, record_file.empty() ? nullptr : &log);
+    if (!record_file.empty())
+    {
+        ofstream record(record_file);
+        if (!record)
+        {
+            cerr << "error: cannot write " << record_file << endl;
+            return 1;
+        }
+        // Координаты снимка базы должны повториться точно, поэтому числа — со всеми знаками
+        record << setprecision(17);
+        json::Print(json::Document(request_log::ToJson(log)), record);
+    }
+    if (!trace_file.empty())
+    {
+        ofstream trace(trace_file);
+        if (!trace)
+        {
+            cerr << "error: cannot write " << trace_file << endl;
+            return 1;
+        }
+        tracing::WriteChromeTrace(trace);
+    }
+    if (!print_stats)
+    {
+        if (collect_stats)
+        {
+            json::Print(json::Document(run_stats.GetSlowRequests()), cerr);
+            cerr << endl;
+        }
+        return 0;
+    }
+    const json::Document report(run_stats.ToJson());
+    if (stats_file.empty())
+    {
+        json::Print(report, cerr);
+        cerr << endl;
+        return 0;
+    }
+    ofstream output(stats_file);
+    if (!output)
+    {
+        cerr << "error: cannot write " << stats_file << endl;
+        return 1;
+    }
+    json::Print(report, output);
 }
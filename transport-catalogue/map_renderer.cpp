@@ -1,4 +1,5 @@
 #include "map_renderer.h"
+#include "tracing.h"
 
 namespace map_renderer
 {
@@ -213,6 +214,7 @@ namespace map_renderer
     }
     void MapRenderer::DrawMap(std::ostream &output, const TransportCatalogue &transport_catalogue)
     {
+        tracing::Span projection_span("SphereProjector", "map");
         auto coordinates = transport_catalogue.GetCoordinates();
         auto end = coordinates.end();
         for (auto it = coordinates.begin(); it != end; ++it)
@@ -224,12 +226,23 @@ namespace map_renderer
         // Создаём проектор сферических координат на карту
         const SphereProjector proj{coordinates.begin(), coordinates.end(), settings_.width, settings_.height, settings_.padding};
 
+        projection_span.End();
+
         svg::Document doc;
 
+        tracing::Span lines_span("DrawLines", "map");
         DrawLines(doc, proj, transport_catalogue);
+        lines_span.End();
+        tracing::Span bus_names_span("DrawBusNames", "map");
         DrawBusNames(doc, proj, transport_catalogue);
+        bus_names_span.End();
+        tracing::Span stops_span("DrawStops", "map");
         DrawStops(doc, proj, transport_catalogue);
+        stops_span.End();
+        tracing::Span stop_names_span("DrawStopNames", "map");
         DrawStopNames(doc, proj, transport_catalogue);
+        stop_names_span.End();
+        tracing::Span render_span("Render", "map");
         doc.Render(output);
     }
 }
\ No newline at end of file
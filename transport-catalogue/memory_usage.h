@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Оценка занятой кучи по содержимому контейнеров, без подмены распределителей памяти.
+// Размеры служебных частей узлов — как в libstdc++ на 64-битных платформах
+namespace memory
+{
+    struct MemoryUsage
+    {
+        size_t bytes = 0;
+        size_t allocations = 0; // блоков в куче
+
+        MemoryUsage &operator+=(const MemoryUsage &other)
+        {
+            bytes += other.bytes;
+            allocations += other.allocations;
+            return *this;
+        }
+    };
+
+    // Память одной части программы: справочника, графа, таблицы маршрутов, ...
+    struct SubsystemUsage
+    {
+        std::string_view subsystem;
+        MemoryUsage usage;
+    };
+
+    namespace detail
+    {
+        constexpr size_t TREE_NODE_HEADER = 4 * sizeof(void *);    // цвет и три указателя красно-чёрного дерева
+        constexpr size_t HASH_NODE_HEADER = sizeof(void *) + sizeof(size_t); // следующий узел и сохранённый хеш
+        constexpr size_t SHORT_STRING_CAPACITY = 15;               // строки короче лежат внутри объекта
+        constexpr size_t DEQUE_CHUNK_BYTES = 512;
+    }
+
+    // Только буфер вектора; память, на которую ссылаются элементы, считается отдельно
+    template <typename T>
+    MemoryUsage GetVectorUsage(const std::vector<T> &values)
+    {
+        return {values.capacity() * sizeof(T), values.capacity() > 0 ? size_t{1} : size_t{0}};
+    }
+
+    inline MemoryUsage GetStringUsage(const std::string &value)
+    {
+        if (value.capacity() <= detail::SHORT_STRING_CAPACITY)
+        {
+            return {};
+        }
+        return {value.capacity() + 1, 1};
+    }
+
+    template <typename Key, typename Value, typename Compare>
+    MemoryUsage GetMapUsage(const std::map<Key, Value, Compare> &values)
+    {
+        return {values.size() * (detail::TREE_NODE_HEADER + sizeof(typename std::map<Key, Value, Compare>::value_type)), values.size()};
+    }
+
+    template <typename Key, typename Compare>
+    MemoryUsage GetSetUsage(const std::set<Key, Compare> &values)
+    {
+        return {values.size() * (detail::TREE_NODE_HEADER + sizeof(Key)), values.size()};
+    }
+
+    template <typename Key, typename Value, typename Hash, typename Equal>
+    MemoryUsage GetUnorderedMapUsage(const std::unordered_map<Key, Value, Hash, Equal> &values)
+    {
+        const size_t node_bytes = detail::HASH_NODE_HEADER + sizeof(typename std::unordered_map<Key, Value, Hash, Equal>::value_type);
+        return {values.size() * node_bytes + values.bucket_count() * sizeof(void *), values.size() + 1};
+    }
+
+    template <typename T>
+    MemoryUsage GetDequeUsage(const std::deque<T> &values)
+    {
+        const size_t per_chunk = std::max<size_t>(1, detail::DEQUE_CHUNK_BYTES / sizeof(T));
+        const size_t chunks = values.size() / per_chunk + 1;
+        return {chunks * per_chunk * sizeof(T) + (chunks + 2) * sizeof(void *), chunks + 1};
+    }
+}
@@ -0,0 +1,477 @@
+#pragma once
+
+#include "dijkstra.h"
+#include "graph.h"
+#include "parallel.h"
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph
+{
+    // Размеры многоуровневого оверлея
+    struct OverlayStats
+    {
+        std::vector<size_t> cells;      // ячеек на каждом уровне
+        std::vector<size_t> entries;    // входов ячеек на каждом уровне
+        std::vector<size_t> exits;      // выходов ячеек на каждом уровне
+        size_t clique_weights = 0;      // весов в кликах всех уровней
+        size_t memory_bytes = 0;
+    };
+
+    // Многоуровневый оверлей (customizable route planning). Вершины разбиты на вложенные ячейки:
+    // ячейка уровня level + 1 — объединение ячеек уровня level. Вход ячейки — вершина, в которую ведёт
+    // ребро из другой ячейки, выход — вершина, из которой такое ребро выходит. Разбиение и границы
+    // зависят только от структуры графа; веса учитываются в Customize, которая для каждой ячейки считает
+    // клику — кратчайшие расстояния внутри ячейки от каждого входа до каждого выхода. Клики уровня
+    // level + 1 считаются по кликам уровня level, ячейки одного уровня — параллельно.
+    // Запрос — поиск Дейкстры, который в ячейках from и to идёт по рёбрам графа, а в остальных —
+    // по кликам самого крупного уровня, чья ячейка не содержит ни from, ни to.
+    template <typename Weight>
+    class Overlay
+    {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using CellId = uint32_t;
+        using RouteInfo = typename Router<Weight>::RouteInfo;
+
+        // Буферы поиска одного потока; создаются через CreateSearch
+        class Search
+        {
+        public:
+            const SearchStats &GetStats() const
+            {
+                return stats_;
+            }
+
+        private:
+            friend class Overlay;
+
+            explicit Search(size_t vertex_count)
+                : weights_(vertex_count),
+                  prev_vertices_(vertex_count),
+                  prev_edges_(vertex_count),
+                  prev_levels_(vertex_count),
+                  reached_marks_(vertex_count, 0),
+                  settled_marks_(vertex_count, 0)
+            {
+            }
+
+            std::vector<Weight> weights_;
+            std::vector<VertexId> prev_vertices_;
+            std::vector<EdgeId> prev_edges_; // NO_EDGE — в вершину пришли по клике
+            std::vector<uint32_t> prev_levels_; // уровень клики
+            std::vector<uint32_t> reached_marks_;
+            std::vector<uint32_t> settled_marks_;
+            std::priority_queue<std::pair<Weight, VertexId>, std::vector<std::pair<Weight, VertexId>>, std::greater<>> queue_;
+            uint32_t mark_ = 0;
+            SearchStats stats_;
+        };
+
+        // cells[level][vertex] — ячейка вершины на уровне level; ячейки каждого уровня пронумерованы подряд с нуля
+        Overlay(const Graph &graph, std::vector<std::vector<CellId>> cells, size_t threads_count = 1);
+
+        // Пересчёт клик для графа с теми же рёбрами, но другими весами; разбиение не меняется
+        void Customize(const Graph &graph, size_t threads_count = 1);
+
+        Search CreateSearch() const;
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to, Search &search) const;
+
+        OverlayStats GetStats() const;
+
+    private:
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr Weight NO_ROUTE = std::numeric_limits<Weight>::has_infinity ? std::numeric_limits<Weight>::infinity() : std::numeric_limits<Weight>::max();
+        static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+        static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+        struct Level
+        {
+            std::vector<CellId> cells;
+            std::vector<uint32_t> entry_indices; // номер вершины среди входов её ячейки или NO_INDEX
+            std::vector<uint32_t> exit_indices;  // номер вершины среди выходов её ячейки или NO_INDEX
+            std::vector<size_t> entries_offsets; // входы ячейки c — entries[entries_offsets[c], entries_offsets[c + 1])
+            std::vector<VertexId> entries;
+            std::vector<size_t> exits_offsets;
+            std::vector<VertexId> exits;
+            std::vector<size_t> clique_offsets; // клика ячейки c — матрица входы x выходы с cliques[clique_offsets[c]]
+            std::vector<Weight> cliques;
+
+            size_t GetExitsCount(CellId cell) const
+            {
+                return exits_offsets[cell + 1] - exits_offsets[cell];
+            }
+            const Weight *GetCliqueRow(VertexId entry) const
+            {
+                const CellId cell = cells[entry];
+                return cliques.data() + clique_offsets[cell] + entry_indices[entry] * GetExitsCount(cell);
+            }
+        };
+
+        // Поиск Дейкстры из from до target (или до исчерпания очереди): expand(vertex, relax)
+        // вызывает relax(to, weight, edge, level) для каждого ребра или клики, выходящих из vertex
+        template <typename Expand>
+        void RunSearch(VertexId from, std::optional<VertexId> target, Search &search, Expand expand) const;
+
+        // Рёбра графа из vertex, ведущие в ячейку cell уровня level
+        template <typename Relax>
+        void RelaxCellEdges(VertexId vertex, size_t level, CellId cell, Relax &relax) const;
+
+        // Клика ячейки vertex на уровне level и рёбра из vertex в другие ячейки этого уровня,
+        // но внутри ячейки bound_cell уровня bound_level (если он задан)
+        template <typename Relax>
+        void RelaxOverlayEdges(VertexId vertex, size_t level, std::optional<size_t> bound_level, CellId bound_cell, Relax &relax) const;
+
+        void CustomizeCell(size_t level, CellId cell, Search &search);
+
+        // Рёбра графа, из которых складывается переход по клике level из from в to
+        void UnpackClique(VertexId from, VertexId to, size_t level, Search &search, std::vector<EdgeId> &edges) const;
+
+        const Graph *graph_;
+        std::vector<Level> levels_;
+    };
+
+    template <typename Weight>
+    Overlay<Weight>::Overlay(const Graph &graph, std::vector<std::vector<CellId>> cells, size_t threads_count)
+        : graph_(&graph)
+    {
+        const size_t vertex_count = graph.GetVertexCount();
+        levels_.resize(cells.size());
+        for (size_t level_index = 0; level_index < cells.size(); ++level_index)
+        {
+            Level &level = levels_[level_index];
+            level.cells = std::move(cells[level_index]);
+            if (level.cells.size() != vertex_count)
+            {
+                throw std::invalid_argument("Overlay cells do not cover graph vertices");
+            }
+            const size_t cells_count = level.cells.empty() ? 0 : *std::max_element(level.cells.begin(), level.cells.end()) + size_t{1};
+
+            // Границы ячеек: концы рёбер, соединяющих разные ячейки
+            std::vector<bool> is_entry(vertex_count, false);
+            std::vector<bool> is_exit(vertex_count, false);
+            for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id)
+            {
+                const auto &edge = graph.GetEdge(edge_id);
+                if (level.cells[edge.from] != level.cells[edge.to])
+                {
+                    is_exit[edge.from] = true;
+                    is_entry[edge.to] = true;
+                }
+            }
+            auto collect = [&](const std::vector<bool> &is_boundary, std::vector<size_t> &offsets, std::vector<VertexId> &vertices, std::vector<uint32_t> &indices)
+            {
+                offsets.assign(cells_count + 1, 0);
+                for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+                {
+                    if (is_boundary[vertex])
+                    {
+                        ++offsets[level.cells[vertex] + 1];
+                    }
+                }
+                for (size_t cell = 0; cell < cells_count; ++cell)
+                {
+                    offsets[cell + 1] += offsets[cell];
+                }
+                vertices.resize(offsets[cells_count]);
+                indices.assign(vertex_count, NO_INDEX);
+                std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+                for (VertexId vertex = 0; vertex < vertex_count; ++vertex)
+                {
+                    if (is_boundary[vertex])
+                    {
+                        const CellId cell = level.cells[vertex];
+                        indices[vertex] = static_cast<uint32_t>(positions[cell] - offsets[cell]);
+                        vertices[positions[cell]++] = vertex;
+                    }
+                }
+            };
+            collect(is_entry, level.entries_offsets, level.entries, level.entry_indices);
+            collect(is_exit, level.exits_offsets, level.exits, level.exit_indices);
+
+            level.clique_offsets.assign(cells_count + 1, 0);
+            for (size_t cell = 0; cell < cells_count; ++cell)
+            {
+                const size_t entries_count = level.entries_offsets[cell + 1] - level.entries_offsets[cell];
+                level.clique_offsets[cell + 1] = level.clique_offsets[cell] + entries_count * level.GetExitsCount(static_cast<CellId>(cell));
+            }
+            level.cliques.assign(level.clique_offsets[cells_count], NO_ROUTE);
+        }
+        Customize(graph, threads_count);
+    }
+
+    template <typename Weight>
+    void Overlay<Weight>::Customize(const Graph &graph, size_t threads_count)
+    {
+        if (graph.GetVertexCount() != graph_->GetVertexCount() || graph.GetEdgeCount() != graph_->GetEdgeCount())
+        {
+            throw std::invalid_argument("Overlay graph structure differs");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id)
+        {
+            const auto &edge = graph.GetEdge(edge_id);
+            const auto &old_edge = graph_->GetEdge(edge_id);
+            if (edge.from != old_edge.from || edge.to != old_edge.to)
+            {
+                throw std::invalid_argument("Overlay graph structure differs");
+            }
+        }
+        graph_ = &graph;
+
+        // Уровень level опирается на клики уровня level - 1, ячейки одного уровня независимы
+        std::vector<std::optional<Search>> searches(std::max<size_t>(1, threads_count));
+        for (size_t level = 0; level < levels_.size(); ++level)
+        {
+            const size_t cells_count = levels_[level].entries_offsets.size() - 1;
+            parallel::ForEachIndex(cells_count, searches.size(), [&](size_t cell, size_t thread_index)
+                                   {
+                                       auto &search = searches[thread_index];
+                                       if (!search)
+                                       {
+                                           search.emplace(CreateSearch());
+                                       }
+                                       CustomizeCell(level, static_cast<CellId>(cell), *search); });
+        }
+    }
+
+    template <typename Weight>
+    void Overlay<Weight>::CustomizeCell(size_t level_index, CellId cell, Search &search)
+    {
+        Level &level = levels_[level_index];
+        const size_t exits_begin = level.exits_offsets[cell];
+        const size_t exits_count = level.GetExitsCount(cell);
+        for (size_t entry = level.entries_offsets[cell]; entry < level.entries_offsets[cell + 1]; ++entry)
+        {
+            const VertexId from = level.entries[entry];
+            if (level_index == 0)
+            {
+                RunSearch(from, std::nullopt, search, [&](VertexId vertex, auto &relax)
+                          { RelaxCellEdges(vertex, 0, cell, relax); });
+            }
+            else
+            {
+                // Внутри ячейки — по кликам и рёбрам между ячейками предыдущего уровня
+                RunSearch(from, std::nullopt, search, [&](VertexId vertex, auto &relax)
+                          { RelaxOverlayEdges(vertex, level_index - 1, level_index, cell, relax); });
+            }
+            Weight *row = level.cliques.data() + level.clique_offsets[cell] + (entry - level.entries_offsets[cell]) * exits_count;
+            for (size_t exit = 0; exit < exits_count; ++exit)
+            {
+                const VertexId to = level.exits[exits_begin + exit];
+                row[exit] = search.reached_marks_[to] == search.mark_ ? search.weights_[to] : NO_ROUTE;
+            }
+        }
+    }
+
+    template <typename Weight>
+    typename Overlay<Weight>::Search Overlay<Weight>::CreateSearch() const
+    {
+        return Search(graph_->GetVertexCount());
+    }
+
+    template <typename Weight>
+    template <typename Expand>
+    void Overlay<Weight>::RunSearch(VertexId from, std::optional<VertexId> target, Search &search, Expand expand) const
+    {
+        if (++search.mark_ == 0)
+        {
+            std::fill(search.reached_marks_.begin(), search.reached_marks_.end(), 0);
+            std::fill(search.settled_marks_.begin(), search.settled_marks_.end(), 0);
+            search.mark_ = 1;
+        }
+        search.stats_ = {};
+        search.queue_ = {};
+        search.weights_[from] = ZERO_WEIGHT;
+        search.prev_edges_[from] = NO_EDGE;
+        search.prev_vertices_[from] = from;
+        search.reached_marks_[from] = search.mark_;
+        search.queue_.push({ZERO_WEIGHT, from});
+
+        VertexId vertex = from;
+        Weight weight = ZERO_WEIGHT;
+        auto relax = [&](VertexId to, Weight edge_weight, EdgeId edge, uint32_t level)
+        {
+            ++search.stats_.relaxed_edges;
+            const Weight to_weight = weight + edge_weight;
+            if (search.reached_marks_[to] != search.mark_ || to_weight < search.weights_[to])
+            {
+                search.reached_marks_[to] = search.mark_;
+                search.weights_[to] = to_weight;
+                search.prev_vertices_[to] = vertex;
+                search.prev_edges_[to] = edge;
+                search.prev_levels_[to] = level;
+                search.queue_.push({to_weight, to});
+            }
+        };
+        while (!search.queue_.empty())
+        {
+            std::tie(weight, vertex) = search.queue_.top();
+            search.queue_.pop();
+            if (search.settled_marks_[vertex] == search.mark_ || search.weights_[vertex] < weight)
+            {
+                continue;
+            }
+            search.settled_marks_[vertex] = search.mark_;
+            ++search.stats_.settled_vertices;
+            if (target && vertex == *target)
+            {
+                return;
+            }
+            expand(vertex, relax);
+        }
+    }
+
+    template <typename Weight>
+    template <typename Relax>
+    void Overlay<Weight>::RelaxCellEdges(VertexId vertex, size_t level, CellId cell, Relax &relax) const
+    {
+        const auto &cells = levels_[level].cells;
+        for (const EdgeId edge_id : graph_->GetIncidentEdges(vertex))
+        {
+            const auto &edge = graph_->GetEdge(edge_id);
+            if (cells[edge.to] == cell)
+            {
+                relax(edge.to, edge.weight, edge_id, 0);
+            }
+        }
+    }
+
+    template <typename Weight>
+    template <typename Relax>
+    void Overlay<Weight>::RelaxOverlayEdges(VertexId vertex, size_t level_index, std::optional<size_t> bound_level, CellId bound_cell, Relax &relax) const
+    {
+        const Level &level = levels_[level_index];
+        const CellId cell = level.cells[vertex];
+        if (level.entry_indices[vertex] != NO_INDEX)
+        {
+            const Weight *row = level.GetCliqueRow(vertex);
+            const size_t exits_begin = level.exits_offsets[cell];
+            for (size_t exit = 0; exit < level.GetExitsCount(cell); ++exit)
+            {
+                const VertexId to = level.exits[exits_begin + exit];
+                if (row[exit] != NO_ROUTE && to != vertex)
+                {
+                    relax(to, row[exit], NO_EDGE, static_cast<uint32_t>(level_index));
+                }
+            }
+        }
+        if (level.exit_indices[vertex] != NO_INDEX)
+        {
+            for (const EdgeId edge_id : graph_->GetIncidentEdges(vertex))
+            {
+                const auto &edge = graph_->GetEdge(edge_id);
+                if (level.cells[edge.to] != cell && (!bound_level || levels_[*bound_level].cells[edge.to] == bound_cell))
+                {
+                    relax(edge.to, edge.weight, edge_id, 0);
+                }
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename Overlay<Weight>::RouteInfo> Overlay<Weight>::BuildRoute(VertexId from, VertexId to, Search &search) const
+    {
+        // Самый крупный уровень, на котором ячейка вершины не содержит ни from, ни to
+        auto get_query_level = [this, from, to](VertexId vertex) -> std::optional<size_t>
+        {
+            for (size_t level = levels_.size(); level-- > 0;)
+            {
+                const auto &cells = levels_[level].cells;
+                if (cells[vertex] != cells[from] && cells[vertex] != cells[to])
+                {
+                    return level;
+                }
+            }
+            return std::nullopt;
+        };
+        RunSearch(from, to, search, [&](VertexId vertex, auto &relax)
+                  {
+                      const auto level = get_query_level(vertex);
+                      if (!level)
+                      {
+                          for (const EdgeId edge_id : graph_->GetIncidentEdges(vertex))
+                          {
+                              const auto &edge = graph_->GetEdge(edge_id);
+                              relax(edge.to, edge.weight, edge_id, 0);
+                          }
+                      }
+                      else
+                      {
+                          RelaxOverlayEdges(vertex, *level, std::nullopt, 0, relax);
+                      } });
+        if (search.settled_marks_[to] != search.mark_)
+        {
+            return std::nullopt;
+        }
+        const SearchStats stats = search.stats_;
+        RouteInfo route{search.weights_[to], {}};
+
+        // Переходы по кликам раскрываются после основного поиска, буферы которого при этом переиспользуются
+        struct Step
+        {
+            VertexId from;
+            VertexId to;
+            EdgeId edge;
+            uint32_t level;
+        };
+        std::vector<Step> steps;
+        for (VertexId vertex = to; vertex != from; vertex = search.prev_vertices_[vertex])
+        {
+            steps.push_back({search.prev_vertices_[vertex], vertex, search.prev_edges_[vertex], search.prev_levels_[vertex]});
+        }
+        std::reverse(steps.begin(), steps.end());
+        for (const Step &step : steps)
+        {
+            if (step.edge != NO_EDGE)
+            {
+                route.edges.push_back(step.edge);
+            }
+            else
+            {
+                UnpackClique(step.from, step.to, step.level, search, route.edges);
+            }
+        }
+        search.stats_ = stats;
+        return route;
+    }
+
+    template <typename Weight>
+    void Overlay<Weight>::UnpackClique(VertexId from, VertexId to, size_t level, Search &search, std::vector<EdgeId> &edges) const
+    {
+        const CellId cell = levels_[level].cells[from];
+        RunSearch(from, to, search, [&](VertexId vertex, auto &relax)
+                  { RelaxCellEdges(vertex, level, cell, relax); });
+        const size_t begin = edges.size();
+        for (VertexId vertex = to; vertex != from; vertex = search.prev_vertices_[vertex])
+        {
+            edges.push_back(search.prev_edges_[vertex]);
+        }
+        std::reverse(edges.begin() + static_cast<std::ptrdiff_t>(begin), edges.end());
+    }
+
+    template <typename Weight>
+    OverlayStats Overlay<Weight>::GetStats() const
+    {
+        OverlayStats stats;
+        for (const Level &level : levels_)
+        {
+            stats.cells.push_back(level.entries_offsets.size() - 1);
+            stats.entries.push_back(level.entries.size());
+            stats.exits.push_back(level.exits.size());
+            stats.clique_weights += level.cliques.size();
+            stats.memory_bytes += level.cells.size() * (sizeof(CellId) + 2 * sizeof(uint32_t)) + (level.entries_offsets.size() + level.exits_offsets.size() + level.clique_offsets.size()) * sizeof(size_t) + (level.entries.size() + level.exits.size()) * sizeof(VertexId) + level.cliques.size() * sizeof(Weight);
+        }
+        return stats;
+    }
+} // namespace graph
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel
+{
+    // Число потоков по умолчанию: все доступные ядра, но не меньше одного
+    inline size_t DefaultThreadsCount()
+    {
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Вызывает func(index, thread_index) для каждого index из [0, count) на threads_count потоках.
+    // Индексы раздаются порциями по chunk_size через общий атомарный счётчик, поэтому
+    // медленные элементы не задерживают остальные потоки. thread_index позволяет
+    // потоку пользоваться своими буферами без синхронизации.
+    template <typename Func>
+    void ForEachIndex(size_t count, size_t threads_count, Func func, size_t chunk_size = 1)
+    {
+        threads_count = std::max<size_t>(1, std::min(threads_count, count));
+        chunk_size = std::max<size_t>(1, chunk_size);
+        if (threads_count == 1)
+        {
+            for (size_t index = 0; index < count; ++index)
+            {
+                func(index, size_t{0});
+            }
+            return;
+        }
+
+        std::atomic<size_t> next_index{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto worker = [&](size_t thread_index)
+        {
+            try
+            {
+                for (size_t begin = next_index.fetch_add(chunk_size); begin < count; begin = next_index.fetch_add(chunk_size))
+                {
+                    const size_t end = std::min(count, begin + chunk_size);
+                    for (size_t index = begin; index < end; ++index)
+                    {
+                        func(index, thread_index);
+                    }
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(error_mutex);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+                next_index = count;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(threads_count - 1);
+        for (size_t thread_index = 1; thread_index < threads_count; ++thread_index)
+        {
+            threads.emplace_back(worker, thread_index);
+        }
+        worker(0);
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
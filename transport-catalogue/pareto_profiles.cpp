@@ -0,0 +1,141 @@
+#include "pareto_profiles.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace router
+{
+    namespace
+    {
+        constexpr double H_TO_M = 0.06;
+    }
+
+    ParetoProfiles::ParetoProfiles(const guide::TransportCatalogue &transport_catalogue, const std::unordered_map<std::string_view, size_t> &stops_ids, size_t threads_count)
+        : stops_count_(stops_ids.size()),
+          offsets_(stops_ids.size()),
+          labels_(stops_ids.size())
+    {
+        std::unordered_map<std::string_view, uint32_t> buses_ids;
+        for (const auto &[bus, stops] : transport_catalogue.GetOneWayBuses())
+        {
+            buses_ids[bus] = static_cast<uint32_t>(buses_.size());
+            buses_.push_back(bus);
+        }
+
+        const Raptor raptor(transport_catalogue, stops_ids, 0, 1, RaptorMetric::DISTANCE);
+        std::vector<std::optional<Raptor::Search>> searches(std::max<size_t>(1, threads_count));
+        parallel::ForEachIndex(stops_count_, searches.size(), [&](size_t from, size_t thread_index)
+                               {
+                                   auto &search = searches[thread_index];
+                                   if (!search)
+                                   {
+                                       search.emplace(raptor.CreateSearch());
+                                   }
+                                   raptor.Run(from, std::nullopt, std::numeric_limits<double>::infinity(), *search);
+                                   auto &offsets = offsets_[from];
+                                   auto &labels = labels_[from];
+                                   offsets.reserve(stops_count_ + 1);
+                                   offsets.push_back(0);
+                                   for (size_t to = 0; to < stops_count_; ++to)
+                                   {
+                                       for (const auto &label : raptor.GetLabels(to, *search))
+                                       {
+                                           labels.push_back({static_cast<int64_t>(label.value), static_cast<uint32_t>(label.rides), static_cast<uint32_t>(label.last_leg.from_stop),
+                                                             static_cast<uint32_t>(label.last_leg.span_count), buses_ids.at(label.last_leg.bus)});
+                                       }
+                                       offsets.push_back(static_cast<uint32_t>(labels.size()));
+                                   }
+                                   labels.shrink_to_fit(); });
+    }
+
+    const ParetoProfiles::Label *ParetoProfiles::FindBest(size_t from, size_t to, int bus_wait_time, int bus_velocity) const
+    {
+        const Label *best = nullptr;
+        double best_time = std::numeric_limits<double>::infinity();
+        for (uint32_t index = offsets_.at(from).at(to); index < offsets_[from][to + 1]; ++index)
+        {
+            const Label &label = labels_[from][index];
+            const double time = static_cast<double>(label.boardings) * bus_wait_time + static_cast<double>(label.distance) / static_cast<double>(bus_velocity) * H_TO_M;
+            // При равном времени — маршрут с меньшим числом посадок
+            if (time < best_time)
+            {
+                best = &label;
+                best_time = time;
+            }
+        }
+        return best;
+    }
+
+    const ParetoProfiles::Label *ParetoProfiles::FindLabel(size_t from, size_t to, uint32_t max_boardings) const
+    {
+        const Label *found = nullptr;
+        for (uint32_t index = offsets_[from][to]; index < offsets_[from][to + 1] && labels_[from][index].boardings <= max_boardings; ++index)
+        {
+            found = &labels_[from][index];
+        }
+        return found;
+    }
+
+    std::optional<std::vector<RaptorLeg>> ParetoProfiles::BuildLegs(size_t from, size_t to, int bus_wait_time, int bus_velocity) const
+    {
+        std::vector<RaptorLeg> legs;
+        if (from == to)
+        {
+            return legs;
+        }
+        const Label *label = FindBest(from, to, bus_wait_time, bus_velocity);
+        if (!label)
+        {
+            return std::nullopt;
+        }
+        // Начало маршрута с k посадками — лучшая метка остановки посадки не больше чем с k - 1 посадками
+        while (true)
+        {
+            const Label *previous = label->board_stop == from ? nullptr : FindLabel(from, label->board_stop, label->boardings - 1);
+            const int64_t distance = label->distance - (previous ? previous->distance : 0);
+            legs.push_back({buses_[label->bus], label->board_stop, static_cast<int>(label->span_count),
+                            static_cast<double>(static_cast<int>(distance)) / static_cast<double>(bus_velocity) * H_TO_M});
+            if (!previous)
+            {
+                break;
+            }
+            label = previous;
+        }
+        std::reverse(legs.begin(), legs.end());
+        return legs;
+    }
+
+    std::optional<double> ParetoProfiles::GetTotalTime(size_t from, size_t to, int bus_wait_time, int bus_velocity) const
+    {
+        const auto legs = BuildLegs(from, to, bus_wait_time, bus_velocity);
+        if (!legs)
+        {
+            return std::nullopt;
+        }
+        double total_time = 0.0;
+        for (const auto &leg : *legs)
+        {
+            total_time += bus_wait_time;
+            total_time += leg.time;
+        }
+        return total_time;
+    }
+
+    ParetoProfilesStats ParetoProfiles::GetStats() const
+    {
+        ParetoProfilesStats stats;
+        for (size_t from = 0; from < stops_count_; ++from)
+        {
+            for (size_t to = 0; to < stops_count_; ++to)
+            {
+                const size_t profile_size = offsets_[from][to + 1] - offsets_[from][to];
+                stats.pairs += profile_size > 0 ? 1 : 0;
+                stats.max_profile_size = std::max(stats.max_profile_size, profile_size);
+            }
+            stats.labels += labels_[from].size();
+            stats.memory_bytes += offsets_[from].capacity() * sizeof(uint32_t) + labels_[from].capacity() * sizeof(Label);
+        }
+        return stats;
+    }
+}
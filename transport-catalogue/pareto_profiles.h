@@ -0,0 +1,63 @@
+#pragma once
+
+#include "raptor.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace router
+{
+    // Размеры таблицы профилей
+    struct ParetoProfilesStats
+    {
+        size_t pairs = 0;  // пар остановок с маршрутом
+        size_t labels = 0; // меток во всех профилях
+        size_t max_profile_size = 0;
+        size_t memory_bytes = 0;
+    };
+
+    // Маршруты между всеми парами остановок, не зависящие от bus_wait_time и bus_velocity. Время маршрута —
+    // посадки * bus_wait_time + расстояние / bus_velocity * 0.06, поэтому при любых параметрах лучший маршрут
+    // лежит среди Парето-оптимальных по (число посадок, расстояние). Для каждой пары хранится этот профиль:
+    // по метке на каждое число посадок, при котором расстояние уменьшается, и последняя поездка такого маршрута.
+    // Профили из каждой остановки даёт поиск RAPTOR по расстоянию; остановки обрабатываются параллельно.
+    class ParetoProfiles
+    {
+    public:
+        ParetoProfiles(const guide::TransportCatalogue &transport_catalogue, const std::unordered_map<std::string_view, size_t> &stops_ids, size_t threads_count = 1);
+
+        // Поездки лучшего при заданных параметрах маршрута; время поездки считается так же, как вес ребра графа TransportRouter
+        std::optional<std::vector<RaptorLeg>> BuildLegs(size_t from, size_t to, int bus_wait_time, int bus_velocity) const;
+
+        // Время в пути по тем же поездкам, сложенное в порядке маршрута
+        std::optional<double> GetTotalTime(size_t from, size_t to, int bus_wait_time, int bus_velocity) const;
+
+        ParetoProfilesStats GetStats() const;
+
+    private:
+        struct Label
+        {
+            int64_t distance;
+            uint32_t boardings;
+            uint32_t board_stop; // остановка последней посадки
+            uint32_t span_count; // перегонов в последней поездке
+            uint32_t bus;        // номер автобуса последней поездки в buses_
+        };
+
+        // Лучшая при заданных параметрах метка профиля from -> to; nullptr, если маршрута нет
+        const Label *FindBest(size_t from, size_t to, int bus_wait_time, int bus_velocity) const;
+
+        // Метка профиля from -> to с наибольшим числом посадок, не превышающим max_boardings
+        const Label *FindLabel(size_t from, size_t to, uint32_t max_boardings) const;
+
+        size_t stops_count_ = 0;
+        std::vector<std::string_view> buses_;
+        // Профиль from -> to — labels_[from][offsets_[from][to], offsets_[from][to + 1]) по возрастанию числа посадок
+        std::vector<std::vector<uint32_t>> offsets_;
+        std::vector<std::vector<Label>> labels_;
+    };
+}
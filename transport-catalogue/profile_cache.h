@@ -0,0 +1,115 @@
+#pragma once
+
+#include "raptor.h"
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace router
+{
+    // Обращения к кэшу маршрутов одного профиля
+    struct ProfileCacheStats
+    {
+        RoutingProfile profile;
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0; // маршрутов профиля, вытесненных ради новых
+        size_t entries = 0;   // маршрутов профиля в кэше сейчас
+    };
+
+    // Ответы на запросы с профилем (from, to, bus_wait_time, bus_velocity), вытесняются давно не нужные (LRU).
+    // Ёмкость общая для всех профилей, счётчики обращений — по профилям. Потоки обработки запросов
+    // обращаются к кэшу под одной блокировкой; при нулевой ёмкости ничего не хранится
+    template <typename Value>
+    class ProfileCache
+    {
+    public:
+        explicit ProfileCache(size_t capacity)
+            : capacity_(capacity)
+        {
+        }
+
+        std::optional<Value> Find(const RoutingProfile &profile, size_t from, size_t to)
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            Counters &counters = counters_[{profile.bus_wait_time, profile.bus_velocity}];
+            const auto it = index_.find(MakeKey(profile, from, to));
+            if (it == index_.end())
+            {
+                ++counters.misses;
+                return std::nullopt;
+            }
+            ++counters.hits;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return it->second->value;
+        }
+
+        void Insert(const RoutingProfile &profile, size_t from, size_t to, Value value)
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            const Key key = MakeKey(profile, from, to);
+            if (capacity_ == 0 || index_.count(key))
+            {
+                return;
+            }
+            if (entries_.size() == capacity_)
+            {
+                const Key &oldest = entries_.back().key;
+                Counters &oldest_counters = counters_[{std::get<0>(oldest), std::get<1>(oldest)}];
+                --oldest_counters.entries;
+                ++oldest_counters.evictions;
+                index_.erase(oldest);
+                entries_.pop_back();
+            }
+            entries_.push_front({key, std::move(value)});
+            index_.emplace(key, entries_.begin());
+            ++counters_[{profile.bus_wait_time, profile.bus_velocity}].entries;
+        }
+
+        // Счётчики всех профилей, к которым обращались, в порядке (bus_wait_time, bus_velocity)
+        std::vector<ProfileCacheStats> GetStats() const
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            std::vector<ProfileCacheStats> stats;
+            stats.reserve(counters_.size());
+            for (const auto &[profile, counters] : counters_)
+            {
+                stats.push_back({{profile.first, profile.second}, counters.hits, counters.misses, counters.evictions, counters.entries});
+            }
+            return stats;
+        }
+
+    private:
+        using Key = std::tuple<int, int, size_t, size_t>;
+
+        struct Entry
+        {
+            Key key;
+            Value value;
+        };
+
+        struct Counters
+        {
+            size_t hits = 0;
+            size_t misses = 0;
+            size_t evictions = 0;
+            size_t entries = 0;
+        };
+
+        static Key MakeKey(const RoutingProfile &profile, size_t from, size_t to)
+        {
+            return {profile.bus_wait_time, profile.bus_velocity, from, to};
+        }
+
+        size_t capacity_ = 0;
+        mutable std::mutex mutex_;
+        std::list<Entry> entries_; // от недавно нужных к давно не нужным
+        std::map<Key, typename std::list<Entry>::iterator> index_;
+        std::map<std::pair<int, int>, Counters> counters_;
+    };
+}
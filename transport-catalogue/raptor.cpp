@@ -0,0 +1,327 @@
+#include "raptor.h"
+#include "parallel.h"
+
+#include <algorithm>
+
+namespace router
+{
+    namespace
+    {
+        constexpr double H_TO_M = 0.06;
+        constexpr double NO_TIME = std::numeric_limits<double>::infinity();
+        // Меньше позиций линий на поток не окупают запуск потоков в раунде
+        constexpr size_t MIN_POSITIONS_PER_THREAD = 16384;
+
+        // Увеличивает счётчик меток; при переполнении сбрасывает метки, чтобы старые не совпали с новыми
+        void NextMark(uint32_t &mark, std::vector<uint32_t> &marks, std::vector<uint32_t> &other_marks)
+        {
+            if (++mark == 0)
+            {
+                std::fill(marks.begin(), marks.end(), 0);
+                std::fill(other_marks.begin(), other_marks.end(), 0);
+                mark = 1;
+            }
+        }
+    }
+
+    Raptor::Search::Search(size_t stops_count, size_t lines_count)
+        : times_(stops_count, NO_TIME),
+          round_start_times_(stops_count, NO_TIME),
+          reached_marks_(stops_count, 0),
+          started_marks_(stops_count, 0),
+          round_marks_(stops_count, 0),
+          last_records_(stops_count, NO_RECORD),
+          line_marks_(lines_count, 0),
+          line_first_positions_(lines_count, 0)
+    {
+    }
+
+    bool Raptor::Search::IsReached(size_t stop) const
+    {
+        return reached_marks_[stop] == mark_;
+    }
+
+    std::optional<double> Raptor::Search::GetTime(size_t stop) const
+    {
+        if (!IsReached(stop))
+        {
+            return std::nullopt;
+        }
+        return times_[stop];
+    }
+
+    std::vector<size_t> Raptor::Search::GetReachedStops() const
+    {
+        std::vector<size_t> stops = reached_;
+        std::sort(stops.begin(), stops.end(), [this](size_t lhs, size_t rhs)
+                  { return times_[lhs] < times_[rhs] || (times_[lhs] == times_[rhs] && lhs < rhs); });
+        return stops;
+    }
+
+    const graph::SearchStats &Raptor::Search::GetStats() const
+    {
+        return stats_;
+    }
+
+    Raptor::Raptor(const guide::TransportCatalogue &transport_catalogue, const std::unordered_map<std::string_view, size_t> &stops_ids, int bus_wait_time, int bus_velocity,
+                   RaptorMetric metric)
+        : stop_lines_(stops_ids.size()),
+          bus_wait_time_(metric == RaptorMetric::TIME ? bus_wait_time : 0),
+          bus_velocity_(bus_velocity),
+          metric_(metric)
+    {
+        auto add_line = [&](std::string_view bus, const std::vector<std::string_view> &stops, bool is_round)
+        {
+            Line line{bus, {}, {}, is_round};
+            line.stops.reserve(stops.size());
+            line.distances.reserve(stops.size());
+            for (size_t i = 0; i < stops.size(); ++i)
+            {
+                line.stops.push_back(stops_ids.at(stops[i]));
+                line.distances.push_back(i == 0 ? 0 : line.distances.back() + transport_catalogue.GetDistance(stops[i - 1], stops[i]));
+            }
+            for (size_t position = 0; position < line.stops.size(); ++position)
+            {
+                stop_lines_[line.stops[position]].push_back({lines_.size(), position});
+            }
+            lines_.push_back(std::move(line));
+        };
+        for (const auto &[bus, stops] : transport_catalogue.GetOneWayBuses())
+        {
+            if (stops.size() < 2)
+            {
+                continue;
+            }
+            if (transport_catalogue.IsBusRound(bus))
+            {
+                add_line(bus, stops, true);
+            }
+            else
+            {
+                add_line(bus, stops, false);
+                add_line(bus, std::vector<std::string_view>(stops.rbegin(), stops.rend()), false);
+            }
+        }
+    }
+
+    Raptor::Search Raptor::CreateSearch() const
+    {
+        return Search(stop_lines_.size(), lines_.size());
+    }
+
+    double Raptor::GetRideTime(const Line &line, size_t board, size_t alight, const Search &search) const
+    {
+        if (metric_ == RaptorMetric::DISTANCE)
+        {
+            return static_cast<double>(line.distances[alight] - line.distances[board]);
+        }
+        // То же выражение, что и вес ребра в графе TransportRouter
+        return static_cast<double>(static_cast<int>(line.distances[alight] - line.distances[board])) / search.bus_velocity_ * H_TO_M;
+    }
+
+    void Raptor::Run(size_t from, std::optional<size_t> target, double max_time, Search &search, size_t threads_count) const
+    {
+        Run(from, target, max_time, bus_wait_time_, bus_velocity_, search, threads_count);
+    }
+
+    void Raptor::Run(size_t from, std::optional<size_t> target, double max_time, const RoutingProfile &profile, Search &search, size_t threads_count) const
+    {
+        Run(from, target, max_time, metric_ == RaptorMetric::TIME ? profile.bus_wait_time : 0, profile.bus_velocity, search, threads_count);
+    }
+
+    void Raptor::Run(size_t from, std::optional<size_t> target, double max_time, double bus_wait_time, double bus_velocity, Search &search, size_t threads_count) const
+    {
+        search.bus_wait_time_ = bus_wait_time;
+        search.bus_velocity_ = bus_velocity;
+        NextMark(search.mark_, search.reached_marks_, search.started_marks_);
+        search.records_.clear();
+        search.reached_.clear();
+        search.marked_.clear();
+        search.stats_ = {};
+        search.candidates_.resize(std::max<size_t>(1, threads_count));
+        if (max_time < 0.0)
+        {
+            return;
+        }
+
+        search.times_.at(from) = 0.0;
+        search.reached_marks_[from] = search.mark_;
+        search.last_records_[from] = Search::NO_RECORD;
+        search.reached_.push_back(from);
+        search.marked_.push_back(from);
+
+        for (size_t round = 1; !search.marked_.empty(); ++round)
+        {
+            // Время улучшенных остановок фиксируется на начало раунда: садиться можно только
+            // после поездок прошлых раундов
+            NextMark(search.round_mark_, search.round_marks_, search.line_marks_);
+            search.lines_to_scan_.clear();
+            for (const size_t stop : search.marked_)
+            {
+                search.round_start_times_[stop] = search.times_[stop];
+                search.started_marks_[stop] = search.mark_;
+                for (const auto &[line, position] : stop_lines_[stop])
+                {
+                    if (search.line_marks_[line] != search.round_mark_)
+                    {
+                        search.line_marks_[line] = search.round_mark_;
+                        search.line_first_positions_[line] = position;
+                        search.lines_to_scan_.push_back(line);
+                    }
+                    else
+                    {
+                        search.line_first_positions_[line] = std::min(search.line_first_positions_[line], position);
+                    }
+                }
+            }
+            search.marked_.clear();
+            size_t positions_count = 0;
+            for (const size_t line : search.lines_to_scan_)
+            {
+                positions_count += lines_[line].stops.size() - search.line_first_positions_[line];
+            }
+            search.stats_.relaxed_edges += positions_count;
+            const size_t round_threads_count = std::min(search.candidates_.size(), std::max<size_t>(1, positions_count / MIN_POSITIONS_PER_THREAD));
+
+            const double target_time = target && search.IsReached(*target) ? search.times_[*target] : NO_TIME;
+            for (auto &candidates : search.candidates_)
+            {
+                candidates.clear();
+            }
+            parallel::ForEachIndex(search.lines_to_scan_.size(), round_threads_count, [&](size_t index, size_t thread_index)
+                                   {
+                                       const size_t line = search.lines_to_scan_[index];
+                                       ScanLine(line, search.line_first_positions_[line], max_time, target_time, search, search.candidates_[thread_index]); });
+
+            // Слияние улучшений всех потоков
+            for (const auto &candidates : search.candidates_)
+            {
+                for (const auto &candidate : candidates)
+                {
+                    if (search.IsReached(candidate.stop) && !(candidate.time < search.times_[candidate.stop]))
+                    {
+                        continue;
+                    }
+                    if (!search.IsReached(candidate.stop))
+                    {
+                        search.reached_marks_[candidate.stop] = search.mark_;
+                        search.last_records_[candidate.stop] = Search::NO_RECORD;
+                        search.reached_.push_back(candidate.stop);
+                    }
+                    search.times_[candidate.stop] = candidate.time;
+                    search.records_.push_back({round, candidate.time, candidate.line, candidate.board, candidate.alight, search.last_records_[candidate.stop]});
+                    search.last_records_[candidate.stop] = search.records_.size() - 1;
+                    ++search.stats_.settled_vertices;
+                    if (search.round_marks_[candidate.stop] != search.round_mark_)
+                    {
+                        search.round_marks_[candidate.stop] = search.round_mark_;
+                        search.marked_.push_back(candidate.stop);
+                    }
+                }
+            }
+        }
+    }
+
+    void Raptor::ScanLine(size_t line_index, size_t first_position, double max_time, double target_time, const Search &search, std::vector<Search::Candidate> &candidates) const
+    {
+        const Line &line = lines_[line_index];
+        const size_t last_position = line.stops.size() - 1;
+        // Лучшая посадка — с наименьшим «временем прибытия в начало линии»: время на остановке
+        // плюс ожидание минус время пути от начала линии. Для кольцевых линий отдельно хранится
+        // лучшая посадка не на первой остановке: от первой до последней ехать нельзя
+        std::optional<size_t> board;
+        double board_key = NO_TIME;
+        std::optional<size_t> inner_board;
+        double inner_board_key = NO_TIME;
+        for (size_t position = first_position; position <= last_position; ++position)
+        {
+            const size_t stop = line.stops[position];
+            const std::optional<size_t> used_board = line.is_round && position == last_position ? inner_board : board;
+            if (used_board)
+            {
+                const double time = search.round_start_times_[line.stops[*used_board]] + search.bus_wait_time_ + GetRideTime(line, *used_board, position, search);
+                const bool improves = !search.IsReached(stop) || time < search.times_[stop];
+                if (improves && time <= max_time && time < target_time)
+                {
+                    candidates.push_back({stop, time, line_index, *used_board, position});
+                }
+            }
+            if (position == last_position || search.started_marks_[stop] != search.mark_)
+            {
+                continue;
+            }
+            const double start_time = search.round_start_times_[stop] + search.bus_wait_time_;
+            if (start_time > max_time || start_time >= target_time)
+            {
+                continue;
+            }
+            const double key = start_time - GetRideTime(line, 0, position, search);
+            if (!board || key < board_key)
+            {
+                board = position;
+                board_key = key;
+            }
+            if (position > 0 && (!inner_board || key < inner_board_key))
+            {
+                inner_board = position;
+                inner_board_key = key;
+            }
+        }
+    }
+
+    std::optional<std::vector<RaptorLeg>> Raptor::BuildLegs(size_t stop, const Search &search) const
+    {
+        if (!search.IsReached(stop))
+        {
+            return std::nullopt;
+        }
+        std::vector<RaptorLeg> legs;
+        for (size_t record_index = search.last_records_[stop]; record_index != Search::NO_RECORD;)
+        {
+            const auto &record = search.records_[record_index];
+            const Line &line = lines_[record.line];
+            const size_t board_stop = line.stops[record.board];
+            legs.push_back({line.bus, board_stop, static_cast<int>(record.alight - record.board), GetRideTime(line, record.board, record.alight, search)});
+            // Время остановки посадки, по которому садились, — последнее улучшение до этого раунда
+            record_index = search.last_records_[board_stop];
+            while (record_index != Search::NO_RECORD && search.records_[record_index].round >= record.round)
+            {
+                record_index = search.records_[record_index].prev_record;
+            }
+        }
+        std::reverse(legs.begin(), legs.end());
+        return legs;
+    }
+
+    std::vector<RaptorLabel> Raptor::GetLabels(size_t stop, const Search &search) const
+    {
+        std::vector<RaptorLabel> labels;
+        if (!search.IsReached(stop))
+        {
+            return labels;
+        }
+        // Улучшения идут от новых к старым; из нескольких улучшений одного раунда лучшее — последнее
+        for (size_t record_index = search.last_records_[stop]; record_index != Search::NO_RECORD; record_index = search.records_[record_index].prev_record)
+        {
+            const auto &record = search.records_[record_index];
+            if (!labels.empty() && labels.back().rides == record.round)
+            {
+                continue;
+            }
+            const Line &line = lines_[record.line];
+            labels.push_back({record.round, record.time, {line.bus, line.stops[record.board], static_cast<int>(record.alight - record.board), GetRideTime(line, record.board, record.alight, search)}});
+        }
+        std::reverse(labels.begin(), labels.end());
+        return labels;
+    }
+
+    size_t Raptor::GetMemoryBytes() const
+    {
+        size_t bytes = lines_.size() * sizeof(Line) + stop_lines_.size() * sizeof(std::vector<StopLine>);
+        for (const auto &line : lines_)
+        {
+            bytes += line.stops.size() * (sizeof(size_t) + sizeof(int64_t) + sizeof(StopLine));
+        }
+        return bytes;
+    }
+}
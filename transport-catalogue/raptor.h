@@ -0,0 +1,173 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include "dijkstra.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace router
+{
+    // Поездка на одном автобусе в маршруте, найденном Raptor
+    struct RaptorLeg
+    {
+        std::string_view bus;
+        size_t from_stop;   // остановка посадки
+        int span_count;     // число перегонов
+        double time;        // время в автобусе, без ожидания
+    };
+
+    // Парето-оптимальная метка остановки: лучшее значение среди маршрутов не больше чем из rides поездок
+    struct RaptorLabel
+    {
+        size_t rides;
+        double value;
+        RaptorLeg last_leg;
+    };
+
+    // Время ожидания и скорость автобусов, с которыми ищутся маршруты
+    struct RoutingProfile
+    {
+        int bus_wait_time = 0;
+        int bus_velocity = 0;
+
+        bool operator==(const RoutingProfile &other) const
+        {
+            return bus_wait_time == other.bus_wait_time && bus_velocity == other.bus_velocity;
+        }
+    };
+
+    // Что минимизирует Raptor
+    enum class RaptorMetric
+    {
+        TIME,    // время в пути: ожидания и поездки со скоростью bus_velocity
+        DISTANCE // расстояние в метрах; ожидания не учитываются, раунд — число посадок
+    };
+
+    // Поиск по линиям автобусов (RAPTOR) без графа пересадок: k-й раунд добавляет k-ю поездку.
+    // В раунде каждая линия, проходящая через остановки, улучшенные в прошлом раунде, просматривается
+    // один раз от первой такой остановки. Линия — направление автобуса: кольцевой едет в одну сторону
+    // (без поездки от первой остановки до последней), некольцевой — в обе. Расстояния вдоль линии
+    // хранятся префиксными суммами целых метров, поэтому время поездки совпадает с весом ребра графа
+    // TransportRouter. Линии одного раунда независимы и могут просматриваться на нескольких потоках.
+    class Raptor
+    {
+    public:
+        // Буферы поиска одного потока; создаются через CreateSearch
+        class Search
+        {
+        public:
+            std::optional<double> GetTime(size_t stop) const;
+
+            // Остановки с найденным временем в порядке неубывания времени
+            std::vector<size_t> GetReachedStops() const;
+
+            const graph::SearchStats &GetStats() const;
+
+        private:
+            friend class Raptor;
+
+            Search(size_t stops_count, size_t lines_count);
+
+            static constexpr size_t NO_RECORD = std::numeric_limits<size_t>::max();
+
+            // Улучшение времени остановки в раунде: на какой линии, откуда и докуда ехали
+            struct Record
+            {
+                size_t round;
+                double time;
+                size_t line;
+                size_t board;  // позиция посадки на линии
+                size_t alight; // позиция высадки
+                size_t prev_record; // прошлое улучшение той же остановки
+            };
+
+            struct Candidate
+            {
+                size_t stop;
+                double time;
+                size_t line;
+                size_t board;
+                size_t alight;
+            };
+
+            bool IsReached(size_t stop) const;
+
+            std::vector<double> times_;
+            std::vector<double> round_start_times_; // время на начало текущего раунда
+            std::vector<uint32_t> reached_marks_;
+            std::vector<uint32_t> started_marks_;
+            std::vector<uint32_t> round_marks_;
+            std::vector<size_t> last_records_;
+            std::vector<Record> records_;
+            std::vector<size_t> reached_;
+            std::vector<size_t> marked_; // остановки, улучшенные в прошлом раунде
+            std::vector<uint32_t> line_marks_;
+            std::vector<size_t> line_first_positions_;
+            std::vector<size_t> lines_to_scan_;
+            std::vector<std::vector<Candidate>> candidates_; // по потокам, сливаются после раунда
+            double bus_wait_time_ = 0.0; // профиль последнего Run
+            double bus_velocity_ = 0.0;
+            uint32_t mark_ = 0;
+            uint32_t round_mark_ = 0;
+            graph::SearchStats stats_;
+        };
+
+        Raptor(const guide::TransportCatalogue &transport_catalogue, const std::unordered_map<std::string_view, size_t> &stops_ids, int bus_wait_time, int bus_velocity,
+               RaptorMetric metric = RaptorMetric::TIME);
+
+        Search CreateSearch() const;
+
+        // Кратчайшие по времени маршруты из from. Если задана target, отбрасываются улучшения
+        // не быстрее уже найденного времени до неё; max_time ограничивает время в пути. При max_time < 0
+        // не достигнута ни одна остановка, даже from — как у поиска Дейкстры с тем же ограничением
+        void Run(size_t from, std::optional<size_t> target, double max_time, Search &search, size_t threads_count = 1) const;
+
+        // То же с другими временем ожидания и скоростью автобусов: профиль применяется при просмотре линий,
+        // линии не перестраиваются. Для DISTANCE профиль не влияет на поиск
+        void Run(size_t from, std::optional<size_t> target, double max_time, const RoutingProfile &profile, Search &search, size_t threads_count = 1) const;
+
+        // Поездки кратчайшего маршрута до stop после Run; nullopt, если маршрут не найден
+        std::optional<std::vector<RaptorLeg>> BuildLegs(size_t stop, const Search &search) const;
+
+        // Метки stop после Run в порядке возрастания числа поездок (и убывания значения); для from — пусто.
+        // Улучшение в k-м раунде — маршрут из k поездок, который лучше всех маршрутов с меньшим числом поездок
+        std::vector<RaptorLabel> GetLabels(size_t stop, const Search &search) const;
+
+        // Память под линии и индекс остановок
+        size_t GetMemoryBytes() const;
+
+    private:
+        struct Line
+        {
+            std::string_view bus;
+            std::vector<size_t> stops;
+            std::vector<int64_t> distances; // расстояние от начала линии до остановки
+            bool is_round;                   // нельзя проехать от первой остановки до последней
+        };
+
+        // Линия и позиция остановки на ней
+        struct StopLine
+        {
+            size_t line;
+            size_t position;
+        };
+
+        void Run(size_t from, std::optional<size_t> target, double max_time, double bus_wait_time, double bus_velocity, Search &search, size_t threads_count) const;
+
+        // Время поездки при профиле последнего Run поиска search
+        double GetRideTime(const Line &line, size_t board, size_t alight, const Search &search) const;
+
+        void ScanLine(size_t line_index, size_t first_position, double max_time, double target_time, const Search &search, std::vector<Search::Candidate> &candidates) const;
+
+        std::vector<Line> lines_;
+        std::vector<std::vector<StopLine>> stop_lines_;
+        double bus_wait_time_ = 0.0;
+        double bus_velocity_ = 0.0;
+        RaptorMetric metric_ = RaptorMetric::TIME;
+    };
+}
@@ -3,124 +3,472 @@
 #include "transport_router.h"
 #include "json_builder.h"
 #include "router.h"
+#include "parallel.h"
+#include "tracing.h"
 
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
+#include <unordered_map>
 
 namespace guide
 {
-    json::Node RequestHandler::FormBusAndStopAnswer(int id, std::string request_name, std::string name)
+    std::string_view GetRequestTypeName(RequestType type)
     {
-        json::Builder answers_info;
-        answers_info.StartDict();
-        if (request_name == "Bus")
+        switch (type)
         {
-            // std::cout << "Bus" << std::endl;
-            BusInfo bus_info = transport_catalogue_.GetBusInfo(name);
+        case RequestType::BUS:
+            return "bus_requests";
+        case RequestType::STOP:
+            return "stop_requests";
+        case RequestType::MAP:
+            return "map_requests";
+        case RequestType::ROUTE:
+            return "route_requests";
+        case RequestType::ROUTE_MATRIX:
+            return "route_matrix_requests";
+        case RequestType::ISOCHRONE:
+            return "isochrone_requests";
+        }
+        return "unknown_requests";
+    }
 
-            if (bus_info.stops_on_route == 0)
-            {
-                answers_info.Key("request_id").Value(id).Key("error_message").Value(std::string("not found"));
-            }
-            else
+    namespace
+    {
+        std::string GetRequestJsonType(RequestType type)
+        {
+            switch (type)
             {
-                std::setprecision(6);
-                // std::cout << bus_info.curvature << std::endl;
-                answers_info.Key("curvature").Value(bus_info.curvature).Key("request_id").Value(id);
-                answers_info.Key("route_length").Value(bus_info.route_length).Key("stop_count").Value(bus_info.stops_on_route);
-                answers_info.Key("unique_stop_count").Value(bus_info.unique_stops);
+            case RequestType::BUS:
+                return "Bus";
+            case RequestType::STOP:
+                return "Stop";
+            case RequestType::MAP:
+                return "Map";
+            case RequestType::ROUTE:
+                return "Route";
+            case RequestType::ROUTE_MATRIX:
+                return "RouteMatrix";
+            case RequestType::ISOCHRONE:
+                return "Isochrone";
             }
+            return "Unknown";
         }
-        else
+    }
+
+    json::Array RequestHandler::FormAnswers(const std::vector<StatRequest> &requests, size_t threads_count, stats::RunStats *stats, std::vector<double> *ready_times)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        json::Array answers(requests.size());
+        if (ready_times)
+        {
+            ready_times->assign(requests.size(), 0.0);
+        }
+        const auto mark_ready = [&](size_t index)
         {
-            // std::cout << "Stop" << std::endl;
-            std::set<std::string_view> stop_info = transport_catalogue_.GetStopInfo(name);
-            if (*stop_info.begin() == "not found")
+            if (ready_times)
             {
-                answers_info.Key("request_id").Value(id).Key("error_message").Value(std::string("not found"));
+                (*ready_times)[index] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
             }
-            else
+        };
+        std::vector<RequestScratch> scratches(std::max<size_t>(1, threads_count));
+
+        // Без таблицы всех пар Route-запросы группируются по остановке отправления:
+        // одно дерево кратчайших путей отвечает на все запросы группы
+        std::vector<RouteGroup> route_groups;
+        std::vector<size_t> other_requests;
+        std::unordered_map<size_t, size_t> group_by_stop;
+        const bool group_routes = !transport_router_.HasRoutesTable();
+        for (size_t index = 0; index < requests.size(); ++index)
+        {
+            const StatRequest &request = requests[index];
+            if (request.type == RequestType::ROUTE_MATRIX && request.origins && request.destinations)
             {
-                if (*stop_info.begin() == "no buses")
+                // Матрица считается сразу на всех потоках, по строкам
+                stats::ScopedTimer timer(stats, GetRequestTypeName(request.type));
+                tracing::Span span(GetRequestTypeName(request.type), "request", request.id);
+                answers[index] = FormRouteMatrixAnswer(request.id, *request.origins, *request.destinations, scratches.size());
+                mark_ready(index);
+                if (stats)
                 {
-                    answers_info.Key("buses").StartArray().EndArray().Key("request_id").Value(id);
+                    RecordRequest(request, answers[index], timer.Stop(), *stats, nullptr);
                 }
-                else
+                continue;
+            }
+            if (!group_routes || request.type != RequestType::ROUTE || !request.from || !request.to || *request.from == *request.to || request.profile)
+            {
+                other_requests.push_back(index);
+                continue;
+            }
+            const auto [it, inserted] = group_by_stop.emplace(*request.from, route_groups.size());
+            if (inserted)
+            {
+                route_groups.push_back({*request.from, {}, {}});
+            }
+            route_groups[it->second].requests.push_back(index);
+            route_groups[it->second].to.push_back(*request.to);
+        }
+
+        // Запросы замеряются процессорным временем своего потока: потоки работают одновременно
+        const bool timed = stats != nullptr;
+        if (stats)
+        {
+            for (auto &scratch : scratches)
+            {
+                scratch.stats.SetSlowRequestThreshold(stats->GetSlowRequestThreshold());
+            }
+        }
+        parallel::ForEachIndex(route_groups.size(), scratches.size(), [&](size_t group, size_t thread_index)
+                               {
+            FormRouteGroupAnswers(requests, route_groups[group], scratches[thread_index], answers, timed);
+            for (const size_t index : route_groups[group].requests)
+            {
+                mark_ready(index);
+            } });
+        parallel::ForEachIndex(other_requests.size(), scratches.size(), [&](size_t index, size_t thread_index)
+                               {
+            const StatRequest &request = requests[other_requests[index]];
+            RequestScratch &scratch = scratches[thread_index];
+            stats::ScopedTimer timer(timed ? &scratch.stats : nullptr, GetRequestTypeName(request.type), stats::CpuClock::THREAD);
+            tracing::Span span(GetRequestTypeName(request.type), "request", request.id);
+            json::Node &answer = answers[other_requests[index]];
+            answer = FormAnswer(request, scratch);
+            mark_ready(other_requests[index]);
+            if (timed)
+            {
+                const double latency = timer.Stop();
+                RecordRequest(request, answer, latency, scratch.stats, UsesRouteSearch(request) ? &GetRouteSearch(scratch).GetStats() : nullptr);
+            } });
+        if (stats)
+        {
+            for (const auto &scratch : scratches)
+            {
+                stats->Merge(scratch.stats);
+            }
+        }
+        return answers;
+    }
+
+    void RequestHandler::FormRouteGroupAnswers(const std::vector<StatRequest> &requests, const RouteGroup &group, RequestScratch &scratch, json::Array &answers, bool timed)
+    {
+        stats::ScopedTimer timer(timed ? &scratch.stats : nullptr, GetRequestTypeName(RequestType::ROUTE), stats::CpuClock::THREAD, group.requests.size());
+        // В трассировке группа — один отрезок с id первого запроса
+        tracing::Span span("route_group", "request", requests[group.requests.front()].id);
+        const auto routes = transport_router_.GetRoutesInfo(group.from, group.to, GetRouteSearch(scratch));
+        for (size_t i = 0; i < group.requests.size(); ++i)
+        {
+            answers[group.requests[i]] = FormRouteAnswer(requests[group.requests[i]].id, routes[i]);
+        }
+        if (!timed)
+        {
+            return;
+        }
+        // Дерево общее для группы, поэтому задержка группы делится между её запросами поровну,
+        // а в журнал медленных попадают все запросы медленной группы с полной задержкой
+        const double latency = timer.Stop();
+        const size_t size = group.requests.size();
+        for (const size_t index : group.requests)
+        {
+            scratch.stats.AddLatency(GetRequestTypeName(RequestType::ROUTE), latency / static_cast<double>(size));
+            if (scratch.stats.IsSlow(latency))
+            {
+                LogSlowRequest(requests[index], answers[index], latency, scratch.stats, &GetRouteSearch(scratch).GetStats(), size);
+            }
+        }
+    }
+
+    void RequestHandler::RecordRequest(const StatRequest &request, const json::Node &answer, double latency, stats::RunStats &run_stats, const graph::SearchStats *search_stats) const
+    {
+        run_stats.AddLatency(GetRequestTypeName(request.type), latency);
+        if (run_stats.IsSlow(latency))
+        {
+            LogSlowRequest(request, answer, latency, run_stats, search_stats);
+        }
+    }
+
+    void RequestHandler::LogSlowRequest(const StatRequest &request, const json::Node &answer, double latency, stats::RunStats &run_stats, const graph::SearchStats *search_stats, size_t route_group_size) const
+    {
+        json::Builder record;
+        record.StartDict().Key("request").Value(DescribeRequest(request).GetValue()).Key("latency_ms").Value(latency * 1e3);
+        record.Key("engine").Value(std::string(router::GetEngineName(transport_router_.GetEngine())));
+        if (route_group_size > 1)
+        {
+            record.Key("route_group_size").Value(static_cast<int>(route_group_size));
+        }
+        if (search_stats)
+        {
+            record.Key("settled_vertices").Value(static_cast<int>(search_stats->settled_vertices)).Key("relaxed_edges").Value(static_cast<int>(search_stats->relaxed_edges));
+        }
+        // Размер ответа: массивы — числом элементов, строки (карта) — байтами, числа как есть
+        record.Key("answer").StartDict();
+        for (const auto &[key, value] : answer.AsMap())
+        {
+            if (key == "request_id")
+            {
+                continue;
+            }
+            if (value.IsArray())
+            {
+                record.Key(key + "_count").Value(static_cast<int>(value.AsArray().size()));
+            }
+            else if (value.IsString() && key == "map")
+            {
+                record.Key(key + "_bytes").Value(static_cast<int>(value.AsString().size()));
+            }
+            else if (!value.IsMap())
+            {
+                record.Key(key).Value(value.GetValue());
+            }
+        }
+        record.EndDict().EndDict();
+        run_stats.AddSlowRequest(latency, record.Build());
+    }
+
+    json::Node RequestHandler::DescribeRequest(const StatRequest &request) const
+    {
+        json::Builder description;
+        description.StartDict().Key("id").Value(request.id).Key("type").Value(GetRequestJsonType(request.type));
+        if (request.name)
+        {
+            description.Key("name").Value(std::string(*request.name));
+        }
+        if (request.type == RequestType::ROUTE || request.type == RequestType::ISOCHRONE)
+        {
+            if (request.from)
+            {
+                description.Key("from").Value(std::string(transport_router_.GetStopNameById(*request.from)));
+            }
+            if (request.to)
+            {
+                description.Key("to").Value(std::string(transport_router_.GetStopNameById(*request.to)));
+            }
+        }
+        if (request.type == RequestType::ISOCHRONE)
+        {
+            description.Key("max_time").Value(request.max_time);
+        }
+        if (request.profile)
+        {
+            description.Key("bus_wait_time").Value(request.profile->bus_wait_time).Key("bus_velocity").Value(request.profile->bus_velocity);
+        }
+        if (request.origins && request.destinations)
+        {
+            for (const auto &[key, stops] : {std::pair{"from", &*request.origins}, std::pair{"to", &*request.destinations}})
+            {
+                description.Key(key).StartArray();
+                for (const size_t stop : *stops)
                 {
-                    answers_info.Key("request_id").Value(id).Key("buses").StartArray();
-                    for (const auto bus : stop_info)
-                    {
-                        answers_info.Value(std::string(bus));
-                    }
-                    answers_info.EndArray();
+                    description.Value(std::string(transport_router_.GetStopNameById(stop)));
                 }
+                description.EndArray();
             }
         }
+        description.EndDict();
+        return description.Build();
+    }
+
+    bool RequestHandler::UsesRouteSearch(const StatRequest &request) const
+    {
+        if (request.type == RequestType::ROUTE)
+        {
+            return request.from && request.to && *request.from != *request.to && !request.profile && !transport_router_.HasRoutesTable();
+        }
+        return request.type == RequestType::ISOCHRONE && request.from && transport_router_.GetEngine() != router::RoutingEngine::PARETO_PROFILES;
+    }
+
+    router::TransportRouter::RouteSearch &RequestHandler::GetRouteSearch(RequestScratch &scratch) const
+    {
+        if (!scratch.route_search)
+        {
+            scratch.route_search.emplace(transport_router_.CreateSearch());
+        }
+        return *scratch.route_search;
+    }
+
+    json::Node RequestHandler::FormAnswer(const StatRequest &request)
+    {
+        RequestScratch scratch;
+        return FormAnswer(request, scratch);
+    }
+
+    json::Node RequestHandler::FormAnswer(const StatRequest &request, RequestScratch &scratch)
+    {
+        switch (request.type)
+        {
+        case RequestType::BUS:
+            return request.name ? FormBusAnswer(request.id, *request.name) : FormNotFoundAnswer(request.id);
+        case RequestType::STOP:
+            return request.name ? FormStopAnswer(request.id, *request.name) : FormNotFoundAnswer(request.id);
+        case RequestType::MAP:
+            return FormMapAnswer(request.id, scratch);
+        case RequestType::ROUTE:
+            if (!request.from || !request.to)
+            {
+                return FormNotFoundAnswer(request.id);
+            }
+            return request.profile ? FormRouteAnswer(request.id, *request.from, *request.to, *request.profile, scratch) : FormRouteAnswer(request.id, *request.from, *request.to, scratch);
+        case RequestType::ROUTE_MATRIX:
+            return request.origins && request.destinations ? FormRouteMatrixAnswer(request.id, *request.origins, *request.destinations, 1) : FormNotFoundAnswer(request.id);
+        case RequestType::ISOCHRONE:
+            return request.from ? FormIsochroneAnswer(request.id, *request.from, request.max_time, scratch) : FormNotFoundAnswer(request.id);
+        }
+        return FormNotFoundAnswer(request.id);
+    }
+
+    json::Node RequestHandler::FormBusAnswer(int id, std::string_view bus)
+    {
+        json::Builder answers_info;
+        answers_info.StartDict();
+        BusInfo bus_info = transport_catalogue_.GetBusInfo(bus);
+
+        if (bus_info.stops_on_route == 0)
+        {
+            answers_info.Key("request_id").Value(id).Key("error_message").Value(std::string("not found"));
+        }
+        else
+        {
+            answers_info.Key("curvature").Value(bus_info.curvature).Key("request_id").Value(id);
+            answers_info.Key("route_length").Value(bus_info.route_length).Key("stop_count").Value(bus_info.stops_on_route);
+            answers_info.Key("unique_stop_count").Value(bus_info.unique_stops);
+        }
         answers_info.EndDict();
         return answers_info.Build();
     }
 
-    json::Node RequestHandler::FormMapAnswer(int id)
+    json::Node RequestHandler::FormStopAnswer(int id, std::string_view stop)
+    {
+        json::Builder answers_info;
+        answers_info.StartDict();
+        std::set<std::string_view> stop_info = transport_catalogue_.GetStopInfo(stop);
+        if (*stop_info.begin() == "not found")
+        {
+            answers_info.Key("request_id").Value(id).Key("error_message").Value(std::string("not found"));
+        }
+        else if (*stop_info.begin() == "no buses")
+        {
+            answers_info.Key("buses").StartArray().EndArray().Key("request_id").Value(id);
+        }
+        else
+        {
+            answers_info.Key("request_id").Value(id).Key("buses").StartArray();
+            for (const auto bus : stop_info)
+            {
+                answers_info.Value(std::string(bus));
+            }
+            answers_info.EndArray();
+        }
+        answers_info.EndDict();
+        return answers_info.Build();
+    }
+
+    json::Node RequestHandler::FormRouteMatrixAnswer(int id, const std::vector<size_t> &origins, const std::vector<size_t> &destinations, size_t threads_count)
+    {
+        const auto total_times = transport_router_.GetTotalTimes(origins, destinations, threads_count);
+        json::Array rows;
+        rows.reserve(total_times.size());
+        for (const auto &times : total_times)
+        {
+            json::Array row;
+            row.reserve(times.size());
+            for (const auto &time : times)
+            {
+                row.push_back(time ? json::Node(*time) : json::Node(nullptr));
+            }
+            rows.push_back(std::move(row));
+        }
+        json::Builder answers_info;
+        answers_info.StartDict().Key("request_id").Value(id).Key("total_times").Value(std::move(rows)).EndDict();
+        return answers_info.Build();
+    }
+
+    json::Node RequestHandler::FormIsochroneAnswer(int id, size_t stop_from, double max_time, RequestScratch &scratch)
+    {
+        json::Builder answers_info;
+        answers_info.StartDict().Key("request_id").Value(id).Key("stops").StartArray();
+        for (const auto &stop : transport_router_.GetReachableStops(stop_from, max_time, GetRouteSearch(scratch)))
+        {
+            answers_info.StartDict().Key("stop_name").Value(std::string(stop.stop_name)).Key("time").Value(stop.time).EndDict();
+        }
+        answers_info.EndArray().EndDict();
+        return answers_info.Build();
+    }
+
+    json::Node RequestHandler::FormNotFoundAnswer(int id)
+    {
+        json::Builder answers_info;
+        answers_info.StartDict().Key("request_id").Value(id).Key("error_message").Value(std::string("not found")).EndDict();
+        return answers_info.Build();
+    }
+
+    json::Node RequestHandler::FormMapAnswer(int id, RequestScratch &scratch)
     {
         json::Builder answers_info;
         answers_info.StartDict();
 
         // std::cout << "Map" << std::endl;
         answers_info.Key("request_id"s).Value(id);
-        std::ostringstream strm;
-        map_renderer_.DrawMap(strm, transport_catalogue_);
-        std::string s = strm.str();
-        answers_info.Key("map"s).Value(s);
+        scratch.map_stream.str(std::string());
+        map_renderer_.DrawMap(scratch.map_stream, transport_catalogue_);
+        answers_info.Key("map"s).Value(scratch.map_stream.str());
 
         answers_info.EndDict();
         return answers_info.Build();
     }
 
-    json::Node RequestHandler::FormRouteAnswer(int id, std::string stop_from, std::string stop_to)
+    json::Node RequestHandler::FormRouteAnswer(int id, size_t stop_from, size_t stop_to, RequestScratch &scratch)
     {
-        // std::cout << "Route" << std::endl;
+        if (stop_from == stop_to)
+        {
+            json::Builder answers_info;
+            answers_info.StartDict().Key("items").StartArray().EndArray();
+            answers_info.Key("request_id").Value(id).Key("total_time").Value(0);
+            answers_info.EndDict();
+            return answers_info.Build();
+        }
+        if (transport_router_.HasRoutesTable())
+        {
+            return FormRouteAnswer(id, transport_router_.GetRouteInfo(stop_from, stop_to));
+        }
+        return FormRouteAnswer(id, transport_router_.GetRouteInfo(stop_from, stop_to, GetRouteSearch(scratch)));
+    }
+
+    json::Node RequestHandler::FormRouteAnswer(int id, size_t stop_from, size_t stop_to, const router::RoutingProfile &profile, RequestScratch &scratch)
+    {
+        if (stop_from == stop_to)
+        {
+            return FormRouteAnswer(id, stop_from, stop_to, scratch);
+        }
+        return FormRouteAnswer(id, transport_router_.GetRouteInfo(stop_from, stop_to, profile, GetRouteSearch(scratch)));
+    }
 
+    json::Node RequestHandler::FormRouteAnswer(int id, const std::optional<router::RouteItems> &route)
+    {
         json::Builder answers_info;
         answers_info.StartDict();
-        if (stop_from == stop_to)
+        if (!route)
         {
-            answers_info.Key("items");
-            answers_info.StartArray().EndArray();
-            answers_info.Key("request_id").Value(id).Key("total_time").Value(0);
+            answers_info.Key("request_id").Value(id).Key("error_message").Value(std::string("not found"));
         }
         else
         {
-            std::optional<std::vector<std::variant<guide::RouteWaitInfo, guide::RouteBusInfo>>> route = std::move(transport_router_.GetRouteInfo(stop_from, stop_to));
-            if (!route)
-            {
-                answers_info.Key("request_id").Value(id).Key("error_message").Value(std::string("not found"));
-            }
-            else
+            answers_info.Key("items");
+            answers_info.StartArray();
+            double total_time = 0.0;
+            for (const auto &item : route.value())
             {
-                answers_info.Key("items");
-                answers_info.StartArray();
-                std::setprecision(6);
-                double total_time = 0.0;
-                for (const auto &item : route.value())
+                if (std::holds_alternative<guide::RouteWaitInfo>(item))
+                {
+                    answers_info.StartDict().Key("type").Value("Wait").Key("stop_name").Value(std::get<guide::RouteWaitInfo>(item).stop_name).Key("time").Value(std::get<guide::RouteWaitInfo>(item).time).EndDict();
+                    total_time += std::get<guide::RouteWaitInfo>(item).time;
+                }
+                else
                 {
-                    // graph.GetEdge(edge).Print();
-                    if (std::holds_alternative<guide::RouteWaitInfo>(item))
-                    {
-                        // std::cout << "Wait" << std::endl;
-                        answers_info.StartDict().Key("type").Value("Wait").Key("stop_name").Value(std::get<guide::RouteWaitInfo>(item).stop_name).Key("time").Value(std::get<guide::RouteWaitInfo>(item).time).EndDict();
-                        total_time += std::get<guide::RouteWaitInfo>(item).time;
-                    }
-                    else
-                    {
-                        // std::cout << "Bus" << std::endl;
-                        answers_info.StartDict().Key("type").Value("Bus").Key("bus").Value(std::get<guide::RouteBusInfo>(item).bus).Key("span_count").Value(std::get<guide::RouteBusInfo>(item).span_count).Key("time").Value(std::get<guide::RouteBusInfo>(item).time).EndDict();
-                        total_time += std::get<guide::RouteBusInfo>(item).time;
-                    }
+                    answers_info.StartDict().Key("type").Value("Bus").Key("bus").Value(std::get<guide::RouteBusInfo>(item).bus).Key("span_count").Value(std::get<guide::RouteBusInfo>(item).span_count).Key("time").Value(std::get<guide::RouteBusInfo>(item).time).EndDict();
+                    total_time += std::get<guide::RouteBusInfo>(item).time;
                 }
-                std::setprecision(6);
-                answers_info.EndArray().Key("request_id").Value(id).Key("total_time").Value(total_time);
             }
+            answers_info.EndArray().Key("request_id").Value(id).Key("total_time").Value(total_time);
         }
 
         answers_info.EndDict();
@@ -2,16 +2,55 @@
 
 #include <iomanip>
 #include <iosfwd>
+#include <optional>
+#include <sstream>
 #include <string_view>
+#include <vector>
 
 #include "transport_catalogue.h"
 #include "json_builder.h"
 #include "json.h"
 #include "map_renderer.h"
+#include "run_stats.h"
 #include "transport_router.h"
 
 namespace guide
 {
+    enum class RequestType
+    {
+        BUS,
+        STOP,
+        MAP,
+        ROUTE,
+        ROUTE_MATRIX,
+        ISOCHRONE
+    };
+
+    // Имя стадии запросов одного типа в сводке --stats: "bus_requests", "route_requests", ...
+    std::string_view GetRequestTypeName(RequestType type);
+
+    // Разобранный запрос stat_requests: имена уже сопоставлены со справочником
+    struct StatRequest
+    {
+        RequestType type;
+        int id = 0;
+        std::optional<std::string_view> name; // автобус или остановка из справочника (Bus, Stop)
+        std::optional<size_t> from;           // номера остановок в TransportRouter (Route)
+        std::optional<size_t> to;
+        std::optional<std::vector<size_t>> origins; // RouteMatrix: nullopt, если какая-то остановка неизвестна
+        std::optional<std::vector<size_t>> destinations;
+        double max_time = 0.0; // Isochrone: бюджет времени в минутах
+        std::optional<router::RoutingProfile> profile; // Route: свои bus_wait_time и bus_velocity, если заданы
+    };
+
+    // Рабочие буферы одного потока обработки запросов, переиспользуются между запросами
+    struct RequestScratch
+    {
+        std::ostringstream map_stream;
+        std::optional<router::TransportRouter::RouteSearch> route_search;
+        stats::RunStats stats; // время запросов потока, сливается в общую сводку
+    };
+
     class RequestHandler
     {
     public:
@@ -21,11 +60,48 @@ namespace guide
               transport_router_(transport_router)
         {
         }
-        json::Node FormBusAndStopAnswer(int id, std::string request_name, std::string name);
-        json::Node FormMapAnswer(int id);
-        json::Node FormRouteAnswer(int id, std::string stop_from, std::string stop_to);
+        // Ответы на пакет запросов в исходном порядке, обработка на threads_count потоках.
+        // С stats время запросов каждого типа добавляется в сводку; в ready_times — когда был готов каждый ответ,
+        // в секундах от начала пакета
+        json::Array FormAnswers(const std::vector<StatRequest> &requests, size_t threads_count, stats::RunStats *stats = nullptr, std::vector<double> *ready_times = nullptr);
+
+        json::Node FormAnswer(const StatRequest &request);
+        json::Node FormAnswer(const StatRequest &request, RequestScratch &scratch);
+        json::Node FormBusAnswer(int id, std::string_view bus);
+        json::Node FormStopAnswer(int id, std::string_view stop);
+        json::Node FormMapAnswer(int id, RequestScratch &scratch);
+        json::Node FormRouteAnswer(int id, size_t stop_from, size_t stop_to, RequestScratch &scratch);
+        json::Node FormRouteAnswer(int id, size_t stop_from, size_t stop_to, const router::RoutingProfile &profile, RequestScratch &scratch);
+        json::Node FormRouteAnswer(int id, const std::optional<router::RouteItems> &route);
+        json::Node FormRouteMatrixAnswer(int id, const std::vector<size_t> &origins, const std::vector<size_t> &destinations, size_t threads_count);
+        json::Node FormIsochroneAnswer(int id, size_t stop_from, double max_time, RequestScratch &scratch);
+        json::Node FormNotFoundAnswer(int id);
 
     private:
+        // Route-запросы с общей остановкой отправления
+        struct RouteGroup
+        {
+            size_t from;
+            std::vector<size_t> requests; // индексы запросов в пакете
+            std::vector<size_t> to;
+        };
+
+        router::TransportRouter::RouteSearch &GetRouteSearch(RequestScratch &scratch) const;
+
+        void FormRouteGroupAnswers(const std::vector<StatRequest> &requests, const RouteGroup &group, RequestScratch &scratch, json::Array &answers, bool timed);
+
+        // Задержка запроса в гистограмму его типа; медленный запрос — ещё и в журнал вместе со статистикой поиска
+        // (search_stats — nullptr, если ответ дан без поиска) и размерами ответа
+        void RecordRequest(const StatRequest &request, const json::Node &answer, double latency, stats::RunStats &run_stats, const graph::SearchStats *search_stats) const;
+
+        void LogSlowRequest(const StatRequest &request, const json::Node &answer, double latency, stats::RunStats &run_stats, const graph::SearchStats *search_stats, size_t route_group_size = 1) const;
+
+        // Запрос в виде stat_requests, чтобы его можно было повторить отдельно
+        json::Node DescribeRequest(const StatRequest &request) const;
+
+        // Был ли ответ найден поиском по буферам RouteSearch, а не по таблице или кэшу
+        bool UsesRouteSearch(const StatRequest &request) const;
+
         const TransportCatalogue &transport_catalogue_;
         map_renderer::MapRenderer &map_renderer_;
         const router::TransportRouter &transport_router_;
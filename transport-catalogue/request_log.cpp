@@ -0,0 +1,42 @@
+#include "request_log.h"
+
+#include <stdexcept>
+
+namespace request_log
+{
+    json::Node ToJson(const RequestLog &log)
+    {
+        json::Dict root = log.snapshot;
+        root["stat_requests"] = log.requests;
+        json::Array offsets;
+        offsets.reserve(log.offsets.size());
+        for (const double offset : log.offsets)
+        {
+            offsets.emplace_back(offset);
+        }
+        root["recorded"] = json::Dict{{"offsets_s", std::move(offsets)}, {"responses", log.responses}};
+        return root;
+    }
+
+    RequestLog FromJson(const json::Node &root)
+    {
+        RequestLog log;
+        const json::Dict &dict = root.AsMap();
+        for (const char *key : {"base_requests", "render_settings", "routing_settings"})
+        {
+            log.snapshot.emplace(key, dict.at(key));
+        }
+        log.requests = dict.at("stat_requests").AsArray();
+        const json::Dict &recorded = dict.at("recorded").AsMap();
+        for (const auto &offset : recorded.at("offsets_s").AsArray())
+        {
+            log.offsets.push_back(offset.AsDouble());
+        }
+        log.responses = recorded.at("responses").AsArray();
+        if (log.offsets.size() != log.requests.size() || log.responses.size() != log.requests.size())
+        {
+            throw std::invalid_argument("Request log: stat_requests, offsets_s and responses differ in size");
+        }
+        return log;
+    }
+}
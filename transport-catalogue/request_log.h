@@ -0,0 +1,23 @@
+#pragma once
+
+#include "json.h"
+
+#include <vector>
+
+// Журнал запросов для нагрузочного повтора (--record): снимок базы, поток stat_requests,
+// время готовности каждого ответа и сам ответ. Журнал — обычный вход transport_catalogue с ключом "recorded"
+namespace request_log
+{
+    struct RequestLog
+    {
+        json::Dict snapshot;         // base_requests, render_settings, routing_settings
+        json::Array requests;        // stat_requests, на которые есть ответ, в исходном виде
+        std::vector<double> offsets; // секунды от начала пакета до готовности ответа
+        json::Array responses;
+    };
+
+    json::Node ToJson(const RequestLog &log);
+
+    // Бросает std::invalid_argument, если числа запросов, времён и ответов не совпадают
+    RequestLog FromJson(const json::Node &root);
+}
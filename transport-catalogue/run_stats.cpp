@@ -0,0 +1,311 @@
+#include "run_stats.h"
+#include "json_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace stats
+{
+    double GetCpuTime(CpuClock clock)
+    {
+#if defined(CLOCK_PROCESS_CPUTIME_ID) && defined(CLOCK_THREAD_CPUTIME_ID)
+        timespec time{};
+        clock_gettime(clock == CpuClock::THREAD ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID, &time);
+        return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+#else
+        // Без POSIX-часов остаётся только время процесса
+        return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+    }
+
+    size_t GetPeakResidentBytes()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return static_cast<size_t>(usage.ru_maxrss);
+#else
+        // На Linux ru_maxrss в килобайтах
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+        return 0;
+#endif
+    }
+
+    void LatencyHistogram::Record(double seconds)
+    {
+        const size_t bucket = GetBucket(static_cast<uint64_t>(std::max(0.0, seconds) * 1e9));
+        if (counts_.size() <= bucket)
+        {
+            counts_.resize(bucket + 1);
+        }
+        ++counts_[bucket];
+        ++count_;
+        sum_ += seconds;
+        max_ = std::max(max_, seconds);
+    }
+
+    void LatencyHistogram::Merge(const LatencyHistogram &other)
+    {
+        if (counts_.size() < other.counts_.size())
+        {
+            counts_.resize(other.counts_.size());
+        }
+        for (size_t bucket = 0; bucket < other.counts_.size(); ++bucket)
+        {
+            counts_[bucket] += other.counts_[bucket];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    size_t LatencyHistogram::GetCount() const
+    {
+        return count_;
+    }
+
+    double LatencyHistogram::GetPercentile(double share) const
+    {
+        if (count_ == 0)
+        {
+            return 0.0;
+        }
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(share * static_cast<double>(count_))));
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < counts_.size(); ++bucket)
+        {
+            seen += counts_[bucket];
+            if (seen >= rank)
+            {
+                return std::min(max_, static_cast<double>(GetBucketUpperBound(bucket)) * 1e-9);
+            }
+        }
+        return max_;
+    }
+
+    double LatencyHistogram::GetMax() const
+    {
+        return max_;
+    }
+
+    double LatencyHistogram::GetMean() const
+    {
+        return count_ ? sum_ / static_cast<double>(count_) : 0.0;
+    }
+
+    // Значения меньше SUB_BUCKETS хранятся точно, дальше на каждую степень двойки — SUB_BUCKETS корзин
+    size_t LatencyHistogram::GetBucket(uint64_t nanoseconds)
+    {
+        if (nanoseconds < SUB_BUCKETS)
+        {
+            return static_cast<size_t>(nanoseconds);
+        }
+        int magnitude = 0;
+        while ((nanoseconds >> magnitude) >= 2 * SUB_BUCKETS)
+        {
+            ++magnitude;
+        }
+        return static_cast<size_t>(SUB_BUCKETS * (magnitude + 1) + ((nanoseconds >> magnitude) - SUB_BUCKETS));
+    }
+
+    uint64_t LatencyHistogram::GetBucketUpperBound(size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+        {
+            return bucket;
+        }
+        const uint64_t magnitude = bucket / SUB_BUCKETS - 1;
+        const uint64_t sub_bucket = bucket % SUB_BUCKETS + SUB_BUCKETS;
+        return ((sub_bucket + 1) << magnitude) - 1;
+    }
+
+    void RunStats::AddPhase(std::string_view name, double wall_time, double cpu_time, size_t count)
+    {
+        for (auto &phase : phases_)
+        {
+            if (phase.name == name)
+            {
+                phase.wall_time += wall_time;
+                phase.cpu_time += cpu_time;
+                phase.count += count;
+                return;
+            }
+        }
+        phases_.push_back({std::string(name), wall_time, cpu_time, count});
+    }
+
+    void RunStats::AddLatency(std::string_view name, double seconds)
+    {
+        for (auto &[latency_name, histogram] : latencies_)
+        {
+            if (latency_name == name)
+            {
+                histogram.Record(seconds);
+                return;
+            }
+        }
+        latencies_.emplace_back(std::string(name), LatencyHistogram{});
+        latencies_.back().second.Record(seconds);
+    }
+
+    void RunStats::SetSlowRequestThreshold(std::optional<double> seconds)
+    {
+        slow_request_threshold_ = seconds;
+    }
+
+    std::optional<double> RunStats::GetSlowRequestThreshold() const
+    {
+        return slow_request_threshold_;
+    }
+
+    bool RunStats::IsSlow(double seconds) const
+    {
+        return slow_request_threshold_ && !(seconds < *slow_request_threshold_);
+    }
+
+    void RunStats::SetRequestsOnly(bool requests_only)
+    {
+        requests_only_ = requests_only;
+    }
+
+    bool RunStats::IsRequestsOnly() const
+    {
+        return requests_only_;
+    }
+
+    void RunStats::AddSlowRequest(double seconds, json::Node record)
+    {
+        slow_requests_.emplace_back(seconds, std::move(record));
+    }
+
+    void RunStats::AddMemorySnapshot(MemorySnapshot snapshot)
+    {
+        memory_snapshots_.push_back(std::move(snapshot));
+    }
+
+    void RunStats::SetRouting(json::Node routing)
+    {
+        routing_ = std::move(routing);
+    }
+
+    void RunStats::Merge(const RunStats &other)
+    {
+        for (const auto &phase : other.phases_)
+        {
+            AddPhase(phase.name, phase.wall_time, phase.cpu_time, phase.count);
+        }
+        for (const auto &[name, histogram] : other.latencies_)
+        {
+            const auto it = std::find_if(latencies_.begin(), latencies_.end(), [&name = name](const auto &latency)
+                                         { return latency.first == name; });
+            if (it == latencies_.end())
+            {
+                latencies_.emplace_back(name, histogram);
+            }
+            else
+            {
+                it->second.Merge(histogram);
+            }
+        }
+        slow_requests_.insert(slow_requests_.end(), other.slow_requests_.begin(), other.slow_requests_.end());
+    }
+
+    const std::vector<PhaseStats> &RunStats::GetPhases() const
+    {
+        return phases_;
+    }
+
+    json::Array RunStats::GetSlowRequests() const
+    {
+        std::vector<const std::pair<double, json::Node> *> order;
+        order.reserve(slow_requests_.size());
+        for (const auto &slow_request : slow_requests_)
+        {
+            order.push_back(&slow_request);
+        }
+        std::stable_sort(order.begin(), order.end(), [](const auto *lhs, const auto *rhs)
+                         { return lhs->first > rhs->first; });
+        json::Array records;
+        records.reserve(order.size());
+        for (const auto *slow_request : order)
+        {
+            records.push_back(slow_request->second);
+        }
+        return records;
+    }
+
+    json::Node RunStats::ToJson() const
+    {
+        json::Builder builder;
+        builder.StartDict().Key("peak_rss_mb").Value(static_cast<double>(GetPeakResidentBytes()) / (1 << 20)).Key("phases").StartArray();
+        for (const auto &phase : phases_)
+        {
+            builder.StartDict().Key("phase").Value(phase.name).Key("wall_time_s").Value(phase.wall_time).Key("cpu_time_s").Value(phase.cpu_time).Key("count").Value(static_cast<int>(phase.count)).EndDict();
+        }
+        builder.EndArray().Key("latencies").StartArray();
+        for (const auto &[name, histogram] : latencies_)
+        {
+            builder.StartDict().Key("phase").Value(name).Key("count").Value(static_cast<int>(histogram.GetCount())).Key("mean_ms").Value(histogram.GetMean() * 1e3);
+            builder.Key("p50_ms").Value(histogram.GetPercentile(0.5) * 1e3).Key("p90_ms").Value(histogram.GetPercentile(0.9) * 1e3);
+            builder.Key("p99_ms").Value(histogram.GetPercentile(0.99) * 1e3).Key("p999_ms").Value(histogram.GetPercentile(0.999) * 1e3);
+            builder.Key("max_ms").Value(histogram.GetMax() * 1e3).EndDict();
+        }
+        builder.EndArray().Key("slow_requests").Value(GetSlowRequests()).Key("memory").StartArray();
+        for (const auto &snapshot : memory_snapshots_)
+        {
+            size_t total_bytes = 0;
+            builder.StartDict().Key("phase").Value(snapshot.phase).Key("subsystems").StartArray();
+            for (const auto &[subsystem, usage] : snapshot.subsystems)
+            {
+                builder.StartDict().Key("subsystem").Value(subsystem).Key("bytes").Value(static_cast<double>(usage.bytes)).Key("allocations").Value(static_cast<int>(usage.allocations)).EndDict();
+                total_bytes += usage.bytes;
+            }
+            builder.EndArray().Key("total_bytes").Value(static_cast<double>(total_bytes)).EndDict();
+        }
+        builder.EndArray();
+        if (!routing_.IsNull())
+        {
+            builder.Key("routing").Value(routing_.GetValue());
+        }
+        builder.EndDict();
+        return builder.Build();
+    }
+
+    ScopedTimer::ScopedTimer(RunStats *stats, std::string_view name, CpuClock clock, size_t count)
+        : stats_(stats),
+          name_(name),
+          clock_(clock),
+          count_(count)
+    {
+        if (stats_)
+        {
+            wall_start_ = std::chrono::steady_clock::now();
+            cpu_start_ = GetCpuTime(clock_);
+        }
+    }
+
+    ScopedTimer::~ScopedTimer()
+    {
+        Stop();
+    }
+
+    double ScopedTimer::Stop()
+    {
+        if (!stats_)
+        {
+            return 0.0;
+        }
+        const double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start_).count();
+        stats_->AddPhase(name_, wall_time, GetCpuTime(clock_) - cpu_start_, count_);
+        stats_ = nullptr;
+        return wall_time;
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "json.h"
+#include "memory_usage.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace stats
+{
+    // Суммарное время стадии обработки или запросов одного типа
+    struct PhaseStats
+    {
+        std::string name;
+        double wall_time = 0.0; // секунды
+        double cpu_time = 0.0;
+        size_t count = 0;
+    };
+
+    // Процессорное время всего процесса (все потоки) или только текущего потока
+    enum class CpuClock
+    {
+        PROCESS,
+        THREAD
+    };
+
+    double GetCpuTime(CpuClock clock);
+    // Пиковая занятая процессом память в байтах, 0 — если система её не сообщает
+    size_t GetPeakResidentBytes();
+
+    // Гистограмма задержек в духе HDR: на каждую степень двойки наносекунд по 2^SUB_BUCKET_BITS корзин,
+    // поэтому перцентили точны до 1/32 значения при постоянной памяти
+    class LatencyHistogram
+    {
+    public:
+        void Record(double seconds);
+        void Merge(const LatencyHistogram &other);
+        size_t GetCount() const;
+        // Верхняя граница корзины, в которую попадает доля share значений, в секундах
+        double GetPercentile(double share) const;
+        double GetMax() const;
+        double GetMean() const;
+
+    private:
+        static constexpr int SUB_BUCKET_BITS = 5;
+        static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+
+        static size_t GetBucket(uint64_t nanoseconds);
+        static uint64_t GetBucketUpperBound(size_t bucket);
+
+        std::vector<uint64_t> counts_;
+        size_t count_ = 0;
+        double sum_ = 0.0;
+        double max_ = 0.0;
+    };
+
+    // Память частей программы после стадии
+    struct MemorySnapshot
+    {
+        std::string phase;
+        std::vector<std::pair<std::string, memory::MemoryUsage>> subsystems;
+    };
+
+    // Сводка одного запуска; не потокобезопасна: потоки копят свою и сливают её через Merge
+    class RunStats
+    {
+    public:
+        void AddPhase(std::string_view name, double wall_time, double cpu_time, size_t count = 1);
+        void AddLatency(std::string_view name, double seconds);
+        // Запросы не быстрее порога попадают в журнал медленных запросов; nullopt — журнал не ведётся
+        void SetSlowRequestThreshold(std::optional<double> seconds);
+        std::optional<double> GetSlowRequestThreshold() const;
+        bool IsSlow(double seconds) const;
+        // Только задержки запросов и журнал медленных запросов (--slow_request_ms без --stats):
+        // время стадий, память и сведения о маршрутизаторе не собираются
+        void SetRequestsOnly(bool requests_only);
+        bool IsRequestsOnly() const;
+        void AddSlowRequest(double seconds, json::Node record);
+        void AddMemorySnapshot(MemorySnapshot snapshot);
+        // Сведения о подготовке маршрутизатора: выбранный способ поиска и размеры его структур
+        void SetRouting(json::Node routing);
+        void Merge(const RunStats &other);
+        const std::vector<PhaseStats> &GetPhases() const;
+        // Записи журнала от самого медленного запроса
+        json::Array GetSlowRequests() const;
+        // {"peak_rss_mb": ..., "phases": [{"phase": ..., "wall_time_s": ..., "cpu_time_s": ..., "count": ...}, ...],
+        //  "latencies": [{"phase": ..., "count": ..., "mean_ms": ..., "p50_ms": ..., "p90_ms": ..., "p99_ms": ..., "p999_ms": ..., "max_ms": ...}, ...],
+        //  "slow_requests": [...],
+        //  "memory": [{"phase": ..., "total_bytes": ..., "subsystems": [{"subsystem": ..., "bytes": ..., "allocations": ...}, ...]}, ...],
+        //  "routing": {"engine": ..., ...}} — routing, если задан через SetRouting
+        json::Node ToJson() const;
+
+    private:
+        std::vector<PhaseStats> phases_; // в порядке первого появления
+        std::vector<std::pair<std::string, LatencyHistogram>> latencies_;
+        std::optional<double> slow_request_threshold_;
+        bool requests_only_ = false;
+        std::vector<std::pair<double, json::Node>> slow_requests_;
+        std::vector<MemorySnapshot> memory_snapshots_;
+        json::Node routing_;
+    };
+
+    // Замеряет время от создания до Stop или разрушения. С stats == nullptr часы не читаются вовсе
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(RunStats *stats, std::string_view name, CpuClock clock = CpuClock::PROCESS, size_t count = 1);
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+        ~ScopedTimer();
+
+        // Время по часам в секундах; 0 — если таймер выключен или уже остановлен
+        double Stop();
+
+    private:
+        RunStats *stats_;
+        std::string_view name_;
+        CpuClock clock_;
+        size_t count_;
+        std::chrono::steady_clock::time_point wall_start_;
+        double cpu_start_ = 0.0;
+    };
+}
@@ -0,0 +1,119 @@
+#include "tracing.h"
+
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace tracing
+{
+    namespace
+    {
+        struct Event
+        {
+            std::string_view name;
+            std::string_view category;
+            int64_t id;
+            std::chrono::steady_clock::time_point begin;
+            std::chrono::steady_clock::time_point end;
+        };
+
+        struct ThreadBuffer
+        {
+            size_t thread_id;
+            std::vector<Event> events;
+        };
+
+        struct Registry
+        {
+            std::chrono::steady_clock::time_point start;
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> buffers; // переживают свои потоки до WriteChromeTrace
+        };
+
+        Registry &GetRegistry()
+        {
+            static Registry registry;
+            return registry;
+        }
+
+        ThreadBuffer &GetThreadBuffer()
+        {
+            thread_local ThreadBuffer *buffer = nullptr;
+            if (!buffer)
+            {
+                Registry &registry = GetRegistry();
+                std::lock_guard<std::mutex> guard(registry.mutex);
+                registry.buffers.push_back(std::make_unique<ThreadBuffer>(ThreadBuffer{registry.buffers.size() + 1, {}}));
+                buffer = registry.buffers.back().get();
+            }
+            return *buffer;
+        }
+
+        double ToMicroseconds(std::chrono::steady_clock::duration duration)
+        {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        }
+    }
+
+    void Enable()
+    {
+        GetRegistry().start = std::chrono::steady_clock::now();
+        detail::GetEnabledFlag().store(true, std::memory_order_relaxed);
+    }
+
+    void WriteChromeTrace(std::ostream &output)
+    {
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        const auto flags = output.flags();
+        output << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+        bool first = true;
+        for (const auto &buffer : registry.buffers)
+        {
+            output << (first ? "\n" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->thread_id
+                   << ", \"args\": {\"name\": \"" << (buffer->thread_id == 1 ? "main" : "worker") << "\"}}";
+            first = false;
+            for (const auto &event : buffer->events)
+            {
+                output << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->thread_id
+                       << ", \"ts\": " << ToMicroseconds(event.begin - registry.start) << ", \"dur\": " << ToMicroseconds(event.end - event.begin);
+                if (event.id >= 0)
+                {
+                    output << ", \"args\": {\"id\": " << event.id << "}";
+                }
+                output << "}";
+            }
+        }
+        output << "\n], \"displayTimeUnit\": \"ms\"}\n";
+        output.flags(flags);
+    }
+
+    Span::Span(std::string_view name, std::string_view category, int64_t id)
+        : name_(name),
+          category_(category),
+          id_(id),
+          active_(IsEnabled())
+    {
+        if (active_)
+        {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    Span::~Span()
+    {
+        End();
+    }
+
+    void Span::End()
+    {
+        if (!active_)
+        {
+            return;
+        }
+        GetThreadBuffer().events.push_back({name_, category_, id_, start_, std::chrono::steady_clock::now()});
+        active_ = false;
+    }
+}
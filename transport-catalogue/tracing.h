@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+// Трассировка стадий обработки в формате Chrome trace event: файл открывается в chrome://tracing или Perfetto.
+// Каждый поток пишет отрезки в свой буфер без блокировок; мьютекс берётся один раз, при первом отрезке потока
+namespace tracing
+{
+    namespace detail
+    {
+        inline std::atomic<bool> &GetEnabledFlag()
+        {
+            static std::atomic<bool> enabled{false};
+            return enabled;
+        }
+    }
+
+    // Включает запись; время отрезков отсчитывается от этого вызова
+    void Enable();
+
+    inline bool IsEnabled()
+    {
+        return detail::GetEnabledFlag().load(std::memory_order_relaxed);
+    }
+
+    // Все записанные отрезки как {"traceEvents": [...]}. Вызывается, когда потоки с отрезками уже завершились
+    void WriteChromeTrace(std::ostream &output);
+
+    // Отрезок от создания до End или разрушения. Имя и категория должны жить до WriteChromeTrace
+    // (строковые литералы); id >= 0 попадает в args. Без Enable — только проверка флага
+    class Span
+    {
+    public:
+        explicit Span(std::string_view name, std::string_view category = "pipeline", int64_t id = -1);
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+        ~Span();
+
+        void End();
+
+    private:
+        std::string_view name_;
+        std::string_view category_;
+        int64_t id_;
+        bool active_;
+        std::chrono::steady_clock::time_point start_;
+    };
+}
@@ -135,6 +135,26 @@ namespace guide
         return buses;
     }
 
+    std::optional<std::string_view> TransportCatalogue::FindStop(std::string_view name) const
+    {
+        const auto it = stops_.find(name);
+        if (it == stops_.end())
+        {
+            return std::nullopt;
+        }
+        return it->first;
+    }
+
+    std::optional<std::string_view> TransportCatalogue::FindBus(std::string_view name) const
+    {
+        const auto it = buses_.find(name);
+        if (it == buses_.end())
+        {
+            return std::nullopt;
+        }
+        return it->first;
+    }
+
     void TransportCatalogue::GetAllInfo() const
     {
         std::setprecision(6);
@@ -243,4 +263,35 @@ namespace guide
     {
         return round_buses_.count(bus);
     }
+
+    memory::MemoryUsage TransportCatalogue::GetMemoryUsage() const
+    {
+        memory::MemoryUsage usage = memory::GetMapUsage(stops_);
+        for (const auto *buses : {&buses_, &one_way_buses_})
+        {
+            usage += memory::GetMapUsage(*buses);
+            for (const auto &[bus, stops] : *buses)
+            {
+                usage += memory::GetVectorUsage(stops);
+            }
+        }
+        usage += memory::GetSetUsage(round_buses_);
+        usage += memory::GetDequeUsage(all_items_);
+        for (const auto &item : all_items_)
+        {
+            usage += memory::GetStringUsage(item);
+        }
+        usage += memory::GetMapUsage(stops_and_buses_);
+        for (const auto &[stop, buses] : stops_and_buses_)
+        {
+            usage += memory::GetSetUsage(buses);
+        }
+        usage += memory::GetUnorderedMapUsage(distances_);
+        for (const auto &[stop, distances] : distances_)
+        {
+            usage += memory::GetUnorderedMapUsage(distances);
+        }
+        usage += memory::GetVectorUsage(coordinates_);
+        return usage;
+    }
 }
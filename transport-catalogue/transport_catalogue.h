@@ -4,6 +4,7 @@
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <string_view>
@@ -13,6 +14,7 @@
 #include <vector>
 
 #include "domain.h"
+#include "memory_usage.h"
 
 namespace guide
 {
@@ -33,6 +35,11 @@ namespace guide
 
 		std::set<std::string_view> GetStopInfo(std::string_view name) const;
 
+		// Возвращают имя из справочника (string_view на хранимую строку) или nullopt, если имя неизвестно
+		std::optional<std::string_view> FindStop(std::string_view name) const;
+
+		std::optional<std::string_view> FindBus(std::string_view name) const;
+
 		void GetAllInfo() const;
 
 		const std::map<std::string_view, stop_coordinate::Coordinates>& GetStops() const;
@@ -53,6 +60,9 @@ namespace guide
 
 		bool IsBusRound (std::string_view bus) const;
 
+		// Все контейнеры справочника вместе с хранимыми именами
+		memory::MemoryUsage GetMemoryUsage() const;
+
 	private:
 		std::map<std::string_view, stop_coordinate::Coordinates> stops_;
 		std::map<std::string_view, std::vector<std::string_view>> buses_;
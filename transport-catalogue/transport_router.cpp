@@ -1,20 +1,321 @@
 #include "transport_router.h"
 #include "router.h"
 #include "graph.h"
+#include "parallel.h"
+#include "tracing.h"
 
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <sstream>
+#include <stdexcept>
 
 namespace router
 {
-    TransportRouter::TransportRouter(int bus_wait_time, int bus_velocity, guide::TransportCatalogue &transport_catalogue)
-        : bus_wait_time_(bus_wait_time),
-          bus_velocity_(bus_velocity)
+    namespace
+    {
+        // Скорость релаксаций Флойда—Уоршелла на одном ядре, замерена floyd_warshall_benchmark (-O3)
+        constexpr double CLASSIC_RELAXATIONS_PER_SECOND = 6e8;
+        constexpr double BLOCKED_RELAXATIONS_PER_SECOND = 2e9;
+        // Скорость полного поиска Дейкстры (рёбер в секунду), замерена goal_directed_benchmark (-O3)
+        constexpr double DIJKSTRA_EDGES_PER_SECOND = 5e7;
+
+        std::string FormatMegabytes(size_t bytes)
+        {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(1) << static_cast<double>(bytes) / (1 << 20) << " MB";
+            return out.str();
+        }
+
+        // Ячейка следующего уровня оверлея объединяет 2^OVERLAY_LEVEL_BITS ячеек предыдущего
+        constexpr size_t OVERLAY_LEVEL_BITS = 3;
+
+        // Рекурсивное деление остановок пополам по широте или долготе до глубины depth. Из сечений
+        // в средней трети выбирается то, которое пересекают маршруты с наименьшим числом остановок:
+        // все остановки маршрута, проходящего через две ячейки, становятся их границами.
+        // Возвращает для каждой остановки номер листа — биты выбора половин, начиная со старшего
+        std::vector<uint32_t> PartitionStops(const std::vector<guide::stop_coordinate::Coordinates> &coordinates, const std::vector<std::vector<size_t>> &lines, size_t depth)
+        {
+            const size_t stops_count = coordinates.size();
+            std::vector<std::vector<size_t>> stop_lines(stops_count);
+            for (size_t line = 0; line < lines.size(); ++line)
+            {
+                for (const size_t stop : lines[line])
+                {
+                    stop_lines[stop].push_back(line);
+                }
+            }
+            std::vector<size_t> order(stops_count);
+            for (size_t stop = 0; stop < stops_count; ++stop)
+            {
+                order[stop] = stop;
+            }
+            std::vector<uint32_t> leaves(stops_count, 0);
+            std::vector<size_t> positions(stops_count);
+            std::vector<uint32_t> line_marks(lines.size(), 0);
+            std::vector<size_t> line_first(lines.size());
+            std::vector<size_t> line_last(lines.size());
+            std::vector<size_t> line_stops(lines.size());
+            std::vector<size_t> touched_lines;
+            std::vector<int64_t> cost_changes;
+            uint32_t mark = 0;
+
+            auto sort_by_axis = [&](size_t begin, size_t end, int axis)
+            {
+                std::sort(order.begin() + begin, order.begin() + end, [&](size_t lhs, size_t rhs)
+                          {
+                              const double lhs_value = axis == 0 ? coordinates[lhs].lat : coordinates[lhs].lng;
+                              const double rhs_value = axis == 0 ? coordinates[rhs].lat : coordinates[rhs].lng;
+                              return lhs_value < rhs_value || (lhs_value == rhs_value && lhs < rhs); });
+            };
+            std::function<void(size_t, size_t, size_t, uint32_t)> split = [&](size_t begin, size_t end, size_t depth_left, uint32_t leaf)
+            {
+                if (depth_left == 0)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        leaves[order[i]] = leaf;
+                    }
+                    return;
+                }
+                const size_t count = end - begin;
+                // При равном числе пересечённых остановок предпочтительнее сечение ближе к середине
+                auto distance_to_middle = [count](size_t k)
+                {
+                    return k + k > count ? k + k - count : count - k - k;
+                };
+                size_t best_split = count / 2;
+                int best_axis = 1;
+                int64_t best_cost = std::numeric_limits<int64_t>::max();
+                for (int axis = 0; axis < 2 && count > 1; ++axis)
+                {
+                    sort_by_axis(begin, end, axis);
+                    ++mark;
+                    touched_lines.clear();
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        positions[order[i]] = i - begin;
+                        for (const size_t line : stop_lines[order[i]])
+                        {
+                            if (line_marks[line] != mark)
+                            {
+                                line_marks[line] = mark;
+                                line_first[line] = i - begin;
+                                line_stops[line] = 0;
+                                touched_lines.push_back(line);
+                            }
+                            line_last[line] = i - begin;
+                            ++line_stops[line];
+                        }
+                    }
+                    // Маршрут пересекает сечение k (слева позиции [0, k)), если first < k <= last
+                    cost_changes.assign(count + 1, 0);
+                    for (const size_t line : touched_lines)
+                    {
+                        cost_changes[line_first[line] + 1] += static_cast<int64_t>(line_stops[line]);
+                        cost_changes[line_last[line] + 1] -= static_cast<int64_t>(line_stops[line]);
+                    }
+                    const size_t low = std::max<size_t>(1, count / 3);
+                    const size_t high = std::max(low, count - count / 3);
+                    int64_t cost = 0;
+                    for (size_t k = 1; k <= high; ++k)
+                    {
+                        cost += cost_changes[k];
+                        if (k >= low && (cost < best_cost || (cost == best_cost && distance_to_middle(k) < distance_to_middle(best_split))))
+                        {
+                            best_cost = cost;
+                            best_split = k;
+                            best_axis = axis;
+                        }
+                    }
+                }
+                if (best_axis == 0)
+                {
+                    sort_by_axis(begin, end, 0);
+                }
+                split(begin, begin + best_split, depth_left - 1, leaf << 1);
+                split(begin + best_split, end, depth_left - 1, (leaf << 1) | 1);
+            };
+            split(0, stops_count, depth, 0);
+            return leaves;
+        }
+
+        // Число рёбер графа TransportRouter::BuildGraph без его построения
+        size_t CountGraphEdges(const guide::TransportCatalogue &transport_catalogue)
+        {
+            size_t edges_count = transport_catalogue.GetStopsCount();
+            for (const auto &[name, stops] : transport_catalogue.GetOneWayBuses())
+            {
+                const size_t stops_count = stops.size();
+                if (transport_catalogue.IsBusRound(name))
+                {
+                    // Все пары i < j, кроме первой и последней остановки, и ожидание на первой остановке
+                    edges_count += stops_count > 1 ? stops_count * (stops_count - 1) / 2 : 1;
+                }
+                else
+                {
+                    edges_count += stops_count * (stops_count - 1);
+                }
+            }
+            return edges_count;
+        }
+    }
+
+    std::string_view GetEngineName(RoutingEngine engine)
+    {
+        switch (engine)
+        {
+        case RoutingEngine::ALL_PAIRS:
+            return "all_pairs";
+        case RoutingEngine::ALL_PAIRS_BLOCKED:
+            return "all_pairs_blocked";
+        case RoutingEngine::DIJKSTRA:
+            return "dijkstra";
+        case RoutingEngine::ASTAR:
+            return "astar";
+        case RoutingEngine::ALT:
+            return "alt";
+        case RoutingEngine::BIDIRECTIONAL:
+            return "bidirectional";
+        case RoutingEngine::HUB_LABELS:
+            return "hub_labels";
+        case RoutingEngine::RAPTOR:
+            return "raptor";
+        case RoutingEngine::OVERLAY:
+            return "overlay";
+        case RoutingEngine::PARETO_PROFILES:
+            return "pareto_profiles";
+        case RoutingEngine::AUTO:
+            return "auto";
+        }
+        return "unknown";
+    }
+
+    std::vector<EngineEstimate> EstimateRoutingEngines(size_t vertex_count, size_t edge_count, size_t threads_count, size_t landmarks_count)
+    {
+        const double vertices = static_cast<double>(vertex_count);
+        const double relaxations = vertices * vertices * vertices;
+        // Ячейка таблицы всех пар: вес и 32-битное ребро
+        const size_t table_bytes = vertex_count * vertex_count * (sizeof(double) + sizeof(uint32_t));
+        // Буферы поиска Дейкстры в каждом потоке: вес, потенциал, ребро, три метки и очередь размером с число рёбер
+        const size_t search_bytes = (vertex_count * (2 * sizeof(double) + sizeof(graph::EdgeId) + 3 * sizeof(uint32_t)) + edge_count * sizeof(std::pair<double, graph::VertexId>)) * std::max<size_t>(1, threads_count);
+        // ALT: расстояния от каждой опорной вершины и до неё, по поиску Дейкстры на каждое
+        const size_t landmarks = std::min(landmarks_count, vertex_count);
+        const size_t landmarks_bytes = 2 * landmarks * vertex_count * sizeof(double);
+        const double landmarks_searches = static_cast<double>(landmarks) * (1.0 + 1.0 / static_cast<double>(std::max<size_t>(1, threads_count)));
+        // Координаты остановок (вершин вдвое больше, чем остановок)
+        const size_t coordinates_bytes = vertex_count / 2 * sizeof(guide::stop_coordinate::Coordinates);
+        // Буферы RAPTOR в каждом потоке: два времени, три метки и последнее улучшение на остановку;
+        // линии занимают порядка числа остановок маршрутов и не учитываются
+        const size_t raptor_bytes = vertex_count / 2 * (2 * sizeof(double) + 3 * sizeof(uint32_t) + sizeof(size_t)) * std::max<size_t>(1, threads_count);
+        return {
+            {RoutingEngine::ALL_PAIRS_BLOCKED, table_bytes, relaxations / BLOCKED_RELAXATIONS_PER_SECOND / static_cast<double>(std::max<size_t>(1, threads_count))},
+            {RoutingEngine::ALL_PAIRS, table_bytes, relaxations / CLASSIC_RELAXATIONS_PER_SECOND},
+            {RoutingEngine::ALT, landmarks_bytes + search_bytes, landmarks_searches * static_cast<double>(edge_count) / DIJKSTRA_EDGES_PER_SECOND},
+            {RoutingEngine::ASTAR, coordinates_bytes + search_bytes, 0.0},
+            {RoutingEngine::BIDIRECTIONAL, 2 * search_bytes, 0.0},
+            {RoutingEngine::DIJKSTRA, search_bytes, 0.0},
+            {RoutingEngine::RAPTOR, raptor_bytes, 0.0}};
+    }
+
+    EngineSelection SelectRoutingEngine(size_t vertex_count, size_t edge_count, const RoutingSettings &settings)
+    {
+        std::ostringstream reason;
+        reason << vertex_count << " vertices, " << edge_count << " edges";
+        for (const auto &estimate : EstimateRoutingEngines(vertex_count, edge_count, settings.threads_count, settings.landmarks_count))
+        {
+            if (estimate.memory_bytes > settings.memory_budget_bytes)
+            {
+                reason << "; " << GetEngineName(estimate.engine) << " needs " << FormatMegabytes(estimate.memory_bytes) << " > memory budget " << FormatMegabytes(settings.memory_budget_bytes);
+            }
+            else if (estimate.preprocessing_seconds > settings.preprocessing_budget_seconds)
+            {
+                reason << "; " << GetEngineName(estimate.engine) << " needs ~" << estimate.preprocessing_seconds << " s > preprocessing budget " << settings.preprocessing_budget_seconds << " s";
+            }
+            else
+            {
+                reason << "; " << GetEngineName(estimate.engine) << " fits: " << FormatMegabytes(estimate.memory_bytes) << ", ~" << estimate.preprocessing_seconds << " s preprocessing";
+                return {estimate.engine, reason.str()};
+            }
+        }
+        // RAPTOR без графа и предподсчёта остаётся единственным вариантом, даже если его буферы не укладываются в бюджет
+        reason << "; falling back to " << GetEngineName(RoutingEngine::RAPTOR);
+        return {RoutingEngine::RAPTOR, reason.str()};
+    }
+
+    TransportRouter::TransportRouter(const RoutingSettings &settings, guide::TransportCatalogue &transport_catalogue)
+        : bus_wait_time_(settings.bus_wait_time),
+          bus_velocity_(settings.bus_velocity),
+          engine_(settings.engine),
+          profile_cache_(settings.profile_cache_size)
+    {
+        transport_catalogue_ = &transport_catalogue;
+        stops_names_ = transport_catalogue.GetStopsName();
+        stops_by_id_.assign(stops_names_.begin(), stops_names_.end());
+        for (size_t i = 0; i < stops_by_id_.size(); ++i)
+        {
+            stops_ids_[stops_by_id_[i]] = i;
+        }
+        if (engine_ == RoutingEngine::AUTO)
+        {
+            tracing::Span selection_span("select_routing_engine", "router");
+            // Размер графа считается до построения: RAPTOR граф не нужен
+            const EngineSelection selection = SelectRoutingEngine(2 * GetStopsCount(), CountGraphEdges(transport_catalogue), settings);
+            engine_ = selection.engine;
+            engine_selection_ = selection.reason;
+        }
+        // Отрезок подготовки выбранного способа называется по способу
+        if (engine_ == RoutingEngine::RAPTOR)
+        {
+            tracing::Span engine_span(GetEngineName(engine_), "router");
+            raptor_ = std::make_unique<Raptor>(transport_catalogue, stops_ids_, bus_wait_time_, bus_velocity_);
+            return;
+        }
+        if (engine_ == RoutingEngine::PARETO_PROFILES)
+        {
+            tracing::Span engine_span(GetEngineName(engine_), "router");
+            pareto_profiles_ = std::make_unique<ParetoProfiles>(transport_catalogue, stops_ids_, settings.threads_count);
+            return;
+        }
+        // Веса графа считаются по профилю из настроек; запросы со своим профилем ищутся по линиям RAPTOR (GetProfileRaptor)
+        tracing::Span graph_span("build_graph", "router");
+        BuildGraph(transport_catalogue);
+        graph_span.End();
+        tracing::Span engine_span(GetEngineName(engine_), "router");
+        if (engine_ == RoutingEngine::ALL_PAIRS)
+        {
+            router_ = std::make_unique<graph::Router<double>>(*graph_);
+        }
+        else if (engine_ == RoutingEngine::ALL_PAIRS_BLOCKED)
+        {
+            router_ = std::make_unique<graph::Router<double>>(*graph_, graph::RoutesPrecomputation::BLOCKED, settings.threads_count);
+        }
+        else if (engine_ == RoutingEngine::ASTAR)
+        {
+            InitializeGeoBound(transport_catalogue);
+        }
+        else if (engine_ == RoutingEngine::ALT)
+        {
+            landmarks_ = std::make_unique<graph::Landmarks<double>>(*graph_, settings.landmarks_count, settings.threads_count);
+        }
+        else if (engine_ == RoutingEngine::HUB_LABELS)
+        {
+            InitializeHubLabels(settings.hub_labels_file);
+        }
+        else if (engine_ == RoutingEngine::OVERLAY)
+        {
+            InitializeOverlay(transport_catalogue, settings);
+        }
+    }
+
+    void TransportRouter::BuildGraph(guide::TransportCatalogue &transport_catalogue)
     {
         const double H_TO_M = 0.06;
         const auto stops_count = transport_catalogue.GetStopsCount();
         graph::DirectedWeightedGraph<double> graph(2 * stops_count);
-        stops_names_ = transport_catalogue.GetStopsName();
         const std::map<std::string_view, std::vector<std::string_view>> &buses = transport_catalogue.GetOneWayBuses();
         for (const auto &[name, stops] : buses)
         {
@@ -62,8 +363,122 @@ namespace router
             const graph::Edge<double> edge{i + stops_count, i, static_cast<double>(bus_wait_time_)};
             graph.AddEdge(edge);
         }
-        graph_ = std::move(std::make_unique<graph::DirectedWeightedGraph<double>>(graph));
-        router_ = std::move(std::make_unique<graph::Router<double>>(graph::Router<double>(*graph_)));
+        // Входящие рёбра читают только встречный поиск двунаправленной Дейкстры и обратные поиски меток хабов
+        if (engine_ == RoutingEngine::BIDIRECTIONAL || engine_ == RoutingEngine::HUB_LABELS)
+        {
+            graph.BuildIncomingEdges();
+        }
+        graph_ = std::make_unique<graph::DirectedWeightedGraph<double>>(std::move(graph));
+    }
+
+    void TransportRouter::InitializeHubLabels(const std::string &file)
+    {
+        if (!file.empty())
+        {
+            std::ifstream input(file, std::ios::binary);
+            if (input)
+            {
+                if (auto labels = graph::HubLabels<double>::Load(*graph_, input))
+                {
+                    hub_labels_ = std::make_unique<graph::HubLabels<double>>(std::move(*labels));
+                    hub_labels_loaded_ = true;
+                }
+            }
+        }
+        if (!hub_labels_)
+        {
+            hub_labels_ = std::make_unique<graph::HubLabels<double>>(*graph_);
+            if (!file.empty())
+            {
+                std::ofstream output(file, std::ios::binary);
+                hub_labels_->Save(output);
+                if (!output)
+                {
+                    std::cerr << "hub labels: cannot write " << file << std::endl;
+                }
+            }
+        }
+    }
+
+    void TransportRouter::InitializeOverlay(const guide::TransportCatalogue &transport_catalogue, const RoutingSettings &settings)
+    {
+        const auto &stops = transport_catalogue.GetStops();
+        std::vector<guide::stop_coordinate::Coordinates> coordinates;
+        coordinates.reserve(stops_by_id_.size());
+        for (const auto stop : stops_by_id_)
+        {
+            coordinates.push_back(stops.at(stop));
+        }
+        std::vector<std::vector<size_t>> lines;
+        for (const auto &[name, bus_stops] : transport_catalogue.GetOneWayBuses())
+        {
+            lines.emplace_back();
+            for (const auto stop : bus_stops)
+            {
+                lines.back().push_back(GetStopNumber(stop));
+            }
+        }
+
+        // Глубина деления — до ячеек не больше overlay_cell_size остановок; на верхнем уровне остаётся хотя бы две ячейки
+        const size_t cell_size = std::max<size_t>(1, settings.overlay_cell_size);
+        size_t depth = 0;
+        while ((GetStopsCount() >> depth) > cell_size)
+        {
+            ++depth;
+        }
+        const size_t levels_count = depth == 0 ? 1 : std::max<size_t>(1, std::min(settings.overlay_levels, (depth - 1) / OVERLAY_LEVEL_BITS + 1));
+        const std::vector<uint32_t> leaves = PartitionStops(coordinates, lines, depth);
+
+        // Обе вершины остановки лежат в её ячейке
+        std::vector<std::vector<graph::Overlay<double>::CellId>> cells(levels_count, std::vector<graph::Overlay<double>::CellId>(graph_->GetVertexCount()));
+        for (size_t level = 0; level < levels_count; ++level)
+        {
+            for (size_t stop = 0; stop < GetStopsCount(); ++stop)
+            {
+                cells[level][stop] = cells[level][GetStopVertex(stop)] = leaves[stop] >> (level * OVERLAY_LEVEL_BITS);
+            }
+        }
+        overlay_ = std::make_unique<graph::Overlay<double>>(*graph_, std::move(cells), settings.threads_count);
+    }
+
+    void TransportRouter::InitializeGeoBound(const guide::TransportCatalogue &transport_catalogue)
+    {
+        const double H_TO_M = 0.06;
+        const auto &stops = transport_catalogue.GetStops();
+        stops_coordinates_.clear();
+        stops_coordinates_.reserve(stops_by_id_.size());
+        for (const auto stop : stops_by_id_)
+        {
+            stops_coordinates_.push_back(stops.at(stop));
+        }
+        // Путь автобуса складывается из перегонов, поэтому отношение, верное для каждого перегона
+        // в обе стороны, верно и для любого ребра графа
+        double ratio = std::numeric_limits<double>::infinity();
+        for (const auto &[name, bus_stops] : transport_catalogue.GetOneWayBuses())
+        {
+            for (size_t i = 0; i + 1 < bus_stops.size(); ++i)
+            {
+                const double distance = guide::stop_coordinate::ComputeHaversineDistance(stops.at(bus_stops[i]), stops.at(bus_stops[i + 1]));
+                if (distance > 0.0)
+                {
+                    const int road_distance = std::min(transport_catalogue.GetDistance(bus_stops[i], bus_stops[i + 1]), transport_catalogue.GetDistance(bus_stops[i + 1], bus_stops[i]));
+                    ratio = std::min(ratio, static_cast<double>(road_distance) / distance);
+                }
+            }
+        }
+        if (ratio == std::numeric_limits<double>::infinity() || bus_velocity_ <= 0)
+        {
+            ratio = 0.0;
+        }
+        // Небольшой запас на погрешность округления, чтобы оценка не превышала настоящее время
+        geo_time_factor_ = ratio / static_cast<double>(std::max(1, bus_velocity_)) * H_TO_M * (1.0 - 1e-9);
+    }
+
+    double TransportRouter::GetGeoLowerBound(graph::VertexId vertex, guide::stop_coordinate::Coordinates target) const
+    {
+        // Вершины обоих слоёв одной остановки имеют её координаты
+        const size_t stop = vertex < GetStopsCount() ? vertex : vertex - GetStopsCount();
+        return guide::stop_coordinate::ComputeHaversineDistance(stops_coordinates_[stop], target) * geo_time_factor_;
     }
 
     void TransportRouter::PrintBusInfo() const
@@ -75,38 +490,516 @@ namespace router
 
     size_t TransportRouter::GetStopNumber(std::string_view stop) const
     {
-        return static_cast<size_t>(distance(stops_names_.begin(), stops_names_.find(stop)));
+        const auto it = stops_ids_.find(stop);
+        return it == stops_ids_.end() ? stops_by_id_.size() : it->second;
+    }
+
+    std::optional<size_t> TransportRouter::FindStopId(std::string_view stop) const
+    {
+        const auto it = stops_ids_.find(stop);
+        if (it == stops_ids_.end())
+        {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    std::vector<memory::SubsystemUsage> TransportRouter::GetMemoryUsage() const
+    {
+        std::vector<memory::SubsystemUsage> usage;
+        memory::MemoryUsage stops_index = memory::GetSetUsage(stops_names_);
+        stops_index += memory::GetVectorUsage(stops_by_id_);
+        stops_index += memory::GetUnorderedMapUsage(stops_ids_);
+        stops_index += memory::GetVectorUsage(stops_coordinates_);
+        usage.push_back({"stops_index", stops_index});
+        if (graph_)
+        {
+            usage.push_back({"graph", graph_->GetMemoryUsage()});
+        }
+        if (!bus_edges_.empty())
+        {
+            memory::MemoryUsage bus_edges = memory::GetMapUsage(bus_edges_);
+            for (const auto &[edge, bus] : bus_edges_)
+            {
+                bus_edges += memory::GetStringUsage(bus.first);
+            }
+            usage.push_back({"bus_edges", bus_edges});
+        }
+        if (router_)
+        {
+            usage.push_back({"routes_table", router_->GetMemoryUsage()});
+        }
+        if (landmarks_)
+        {
+            usage.push_back({"landmarks", landmarks_->GetMemoryUsage()});
+        }
+        if (hub_labels_)
+        {
+            usage.push_back({"hub_labels", {hub_labels_->GetStats().memory_bytes, 0}});
+        }
+        if (raptor_)
+        {
+            usage.push_back({"raptor", {raptor_->GetMemoryBytes(), 0}});
+        }
+        if (profile_raptor_)
+        {
+            usage.push_back({"profile_raptor", {profile_raptor_->GetMemoryBytes(), 0}});
+        }
+        if (overlay_)
+        {
+            usage.push_back({"overlay", {overlay_->GetStats().memory_bytes, 0}});
+        }
+        if (pareto_profiles_)
+        {
+            usage.push_back({"pareto_profiles", {pareto_profiles_->GetStats().memory_bytes, 0}});
+        }
+        return usage;
+    }
+
+    std::string_view TransportRouter::GetStopNameById(size_t stop) const
+    {
+        return stops_by_id_.at(stop);
+    }
+
+    graph::VertexId TransportRouter::GetStopVertex(size_t stop) const
+    {
+        return stop + stops_by_id_.size();
+    }
+
+    const graph::SearchStats &TransportRouter::RouteSearch::GetStats() const
+    {
+        static const graph::SearchStats NO_STATS;
+        if (overlay_)
+        {
+            return overlay_->GetStats();
+        }
+        if (raptor_)
+        {
+            return raptor_->GetStats();
+        }
+        return dijkstra_ ? dijkstra_->GetStats() : NO_STATS;
+    }
+
+    TransportRouter::RouteSearch TransportRouter::CreateSearch() const
+    {
+        RouteSearch search;
+        if (raptor_)
+        {
+            search.raptor_.emplace(raptor_->CreateSearch());
+        }
+        else if (graph_)
+        {
+            search.dijkstra_.emplace(*graph_);
+        }
+        if (overlay_)
+        {
+            search.overlay_.emplace(overlay_->CreateSearch());
+        }
+        return search;
+    }
+
+    void TransportRouter::SetRoutingParameters(int bus_wait_time, int bus_velocity, guide::TransportCatalogue &transport_catalogue, size_t threads_count)
+    {
+        if (pareto_profiles_)
+        {
+            bus_wait_time_ = bus_wait_time;
+            bus_velocity_ = bus_velocity;
+            return;
+        }
+        if (!overlay_)
+        {
+            throw std::logic_error("Routing parameters can be changed only for the overlay and pareto_profiles routing engines");
+        }
+        // Старый граф нужен оверлею до Customize: по нему сверяется структура нового
+        const auto old_graph = std::move(graph_);
+        bus_wait_time_ = bus_wait_time;
+        bus_velocity_ = bus_velocity;
+        bus_edges_.clear();
+        BuildGraph(transport_catalogue);
+        overlay_->Customize(*graph_, threads_count);
+    }
+
+    RoutingEngine TransportRouter::GetEngine() const
+    {
+        return engine_;
+    }
+
+    RouterBuildReport TransportRouter::GetBuildReport() const
+    {
+        RouterBuildReport report;
+        report.engine = engine_;
+        report.engine_selection = engine_selection_;
+        if (hub_labels_)
+        {
+            report.hub_labels = hub_labels_->GetStats();
+            report.hub_labels_loaded = hub_labels_loaded_;
+        }
+        if (overlay_)
+        {
+            report.overlay = overlay_->GetStats();
+        }
+        if (pareto_profiles_)
+        {
+            report.pareto_profiles = pareto_profiles_->GetStats();
+        }
+        return report;
     }
 
-    std::optional<std::vector<std::variant<guide::RouteWaitInfo, guide::RouteBusInfo>>> TransportRouter::GetRouteInfo(std::string_view from, std::string_view to) const
+    RoutingProfile TransportRouter::GetRoutingProfile() const
     {
-        const auto route = router_->BuildRoute(GetStopNumber(from) + stops_names_.size(), GetStopNumber(to) + stops_names_.size());
-        std::vector<std::variant<guide::RouteWaitInfo, guide::RouteBusInfo>> route_info;
+        return {bus_wait_time_, bus_velocity_};
+    }
+
+    std::vector<ProfileCacheStats> TransportRouter::GetProfileCacheStats() const
+    {
+        return profile_cache_.GetStats();
+    }
+
+    bool TransportRouter::HasRoutesTable() const
+    {
+        return router_ != nullptr || hub_labels_ != nullptr || pareto_profiles_ != nullptr;
+    }
+
+    bool TransportRouter::HasPointToPointSearch() const
+    {
+        return engine_ == RoutingEngine::ASTAR || engine_ == RoutingEngine::ALT || engine_ == RoutingEngine::BIDIRECTIONAL || engine_ == RoutingEngine::RAPTOR ||
+               engine_ == RoutingEngine::OVERLAY;
+    }
+
+    std::optional<RouteItems> TransportRouter::GetRouteInfo(std::string_view from, std::string_view to) const
+    {
+        return GetRouteInfo(GetStopNumber(from), GetStopNumber(to));
+    }
+
+    std::optional<RouteItems> TransportRouter::GetRouteInfo(size_t from, size_t to) const
+    {
+        if (router_)
+        {
+            const auto route = router_->BuildRoute(GetStopVertex(from), GetStopVertex(to));
+            if (!route)
+            {
+                return std::nullopt;
+            }
+            return MakeRouteItems(route->edges);
+        }
+        if (hub_labels_)
+        {
+            const auto route = hub_labels_->BuildRoute(GetStopVertex(from), GetStopVertex(to));
+            if (!route)
+            {
+                return std::nullopt;
+            }
+            return MakeRouteItems(route->edges);
+        }
+        if (pareto_profiles_)
+        {
+            const auto legs = pareto_profiles_->BuildLegs(from, to, bus_wait_time_, bus_velocity_);
+            if (!legs)
+            {
+                return std::nullopt;
+            }
+            return MakeRouteItems(*legs, bus_wait_time_);
+        }
+        RouteSearch search = CreateSearch();
+        return GetRouteInfo(from, to, search);
+    }
+
+    std::optional<RouteItems> TransportRouter::GetRouteInfo(size_t from, size_t to, RouteSearch &search) const
+    {
+        if (HasRoutesTable())
+        {
+            return GetRouteInfo(from, to);
+        }
+        if (raptor_)
+        {
+            raptor_->Run(from, to, std::numeric_limits<double>::infinity(), *search.raptor_);
+            const auto legs = raptor_->BuildLegs(to, *search.raptor_);
+            if (!legs)
+            {
+                return std::nullopt;
+            }
+            return MakeRouteItems(*legs, bus_wait_time_);
+        }
+        const graph::VertexId target = GetStopVertex(to);
+        if (overlay_)
+        {
+            const auto route = overlay_->BuildRoute(GetStopVertex(from), target, *search.overlay_);
+            if (!route)
+            {
+                return std::nullopt;
+            }
+            return MakeRouteItems(route->edges);
+        }
+        auto &dijkstra = *search.dijkstra_;
+        if (engine_ == RoutingEngine::ASTAR)
+        {
+            const auto target_coordinates = stops_coordinates_[to];
+            dijkstra.BuildTreeToTarget(GetStopVertex(from), target, [this, target_coordinates](graph::VertexId vertex)
+                                     { return GetGeoLowerBound(vertex, target_coordinates); });
+        }
+        else if (engine_ == RoutingEngine::ALT)
+        {
+            dijkstra.BuildTreeToTarget(GetStopVertex(from), target, [this, target](graph::VertexId vertex)
+                                     { return landmarks_->GetLowerBound(vertex, target); });
+        }
+        else if (engine_ == RoutingEngine::BIDIRECTIONAL)
+        {
+            dijkstra.BuildBidirectionalTree(GetStopVertex(from), target);
+        }
+        else
+        {
+            dijkstra.BuildTree(GetStopVertex(from), {target});
+        }
+        const auto route = dijkstra.BuildRoute(target);
         if (!route)
         {
-            return {};
+            return std::nullopt;
+        }
+        return MakeRouteItems(route->edges);
+    }
+
+    std::optional<RouteItems> TransportRouter::GetRouteInfo(size_t from, size_t to, const RoutingProfile &profile, RouteSearch &search) const
+    {
+        if (profile == GetRoutingProfile())
+        {
+            return GetRouteInfo(from, to, search);
+        }
+        if (pareto_profiles_)
+        {
+            const auto legs = pareto_profiles_->BuildLegs(from, to, profile.bus_wait_time, profile.bus_velocity);
+            if (!legs)
+            {
+                return std::nullopt;
+            }
+            return MakeRouteItems(*legs, profile.bus_wait_time);
+        }
+        if (auto route = profile_cache_.Find(profile, from, to))
+        {
+            return std::move(*route);
+        }
+        const Raptor &raptor = raptor_ ? *raptor_ : GetProfileRaptor();
+        if (!search.raptor_ && !search.profile_raptor_)
+        {
+            search.profile_raptor_.emplace(raptor.CreateSearch());
+        }
+        auto &raptor_search = search.raptor_ ? *search.raptor_ : *search.profile_raptor_;
+        raptor.Run(from, to, std::numeric_limits<double>::infinity(), profile, raptor_search);
+        const auto legs = raptor.BuildLegs(to, raptor_search);
+        std::optional<RouteItems> route;
+        if (legs)
+        {
+            route = MakeRouteItems(*legs, profile.bus_wait_time);
+        }
+        profile_cache_.Insert(profile, from, to, route);
+        return route;
+    }
+
+    const Raptor &TransportRouter::GetProfileRaptor() const
+    {
+        std::call_once(profile_raptor_once_, [this]
+                       {
+            tracing::Span profile_raptor_span("profile_raptor", "router");
+            profile_raptor_ = std::make_unique<Raptor>(*transport_catalogue_, stops_ids_, bus_wait_time_, bus_velocity_); });
+        return *profile_raptor_;
+    }
+
+    std::vector<std::optional<RouteItems>> TransportRouter::GetRoutesInfo(size_t from, const std::vector<size_t> &to, RouteSearch &search) const
+    {
+        std::vector<std::optional<RouteItems>> routes;
+        routes.reserve(to.size());
+        // Одиночный маршрут поиск до цели найдёт быстрее, чем дерево
+        if (HasRoutesTable() || (HasPointToPointSearch() && to.size() == 1))
+        {
+            for (const size_t stop : to)
+            {
+                routes.push_back(GetRouteInfo(from, stop, search));
+            }
+            return routes;
+        }
+        if (raptor_)
+        {
+            raptor_->Run(from, std::nullopt, std::numeric_limits<double>::infinity(), *search.raptor_);
+            for (const size_t stop : to)
+            {
+                const auto legs = raptor_->BuildLegs(stop, *search.raptor_);
+                routes.push_back(legs ? std::optional<RouteItems>(MakeRouteItems(*legs, bus_wait_time_)) : std::nullopt);
+            }
+            return routes;
+        }
+        std::vector<graph::VertexId> targets;
+        targets.reserve(to.size());
+        for (const size_t stop : to)
+        {
+            targets.push_back(GetStopVertex(stop));
+        }
+        search.dijkstra_->BuildTree(GetStopVertex(from), targets);
+        for (const graph::VertexId target : targets)
+        {
+            const auto route = search.dijkstra_->BuildRoute(target);
+            routes.push_back(route ? std::optional<RouteItems>(MakeRouteItems(route->edges)) : std::nullopt);
+        }
+        return routes;
+    }
+
+    std::vector<std::vector<std::optional<double>>> TransportRouter::GetTotalTimes(const std::vector<size_t> &origins, const std::vector<size_t> &destinations, size_t threads_count) const
+    {
+        std::vector<std::vector<std::optional<double>>> total_times(origins.size(), std::vector<std::optional<double>>(destinations.size()));
+        std::vector<graph::VertexId> targets;
+        targets.reserve(destinations.size());
+        for (const size_t stop : destinations)
+        {
+            targets.push_back(GetStopVertex(stop));
+        }
+
+        if (router_)
+        {
+            parallel::ForEachIndex(origins.size(), threads_count, [&](size_t row, size_t)
+                                   {
+                                       for (size_t column = 0; column < targets.size(); ++column)
+                                       {
+                                           total_times[row][column] = router_->GetRouteWeight(GetStopVertex(origins[row]), targets[column]);
+                                       } });
+            return total_times;
+        }
+        if (hub_labels_)
+        {
+            parallel::ForEachIndex(origins.size(), threads_count, [&](size_t row, size_t)
+                                   {
+                                       for (size_t column = 0; column < targets.size(); ++column)
+                                       {
+                                           total_times[row][column] = hub_labels_->GetRouteWeight(GetStopVertex(origins[row]), targets[column]);
+                                       } });
+            return total_times;
+        }
+        if (pareto_profiles_)
+        {
+            parallel::ForEachIndex(origins.size(), threads_count, [&](size_t row, size_t)
+                                   {
+                                       for (size_t column = 0; column < destinations.size(); ++column)
+                                       {
+                                           total_times[row][column] = pareto_profiles_->GetTotalTime(origins[row], destinations[column], bus_wait_time_, bus_velocity_);
+                                       } });
+            return total_times;
+        }
+        if (raptor_)
+        {
+            // Одна строка — один поиск RAPTOR из остановки отправления по всем линиям
+            std::vector<std::optional<Raptor::Search>> searches(std::max<size_t>(1, threads_count));
+            parallel::ForEachIndex(origins.size(), searches.size(), [&](size_t row, size_t thread_index)
+                                   {
+                                       auto &search = searches[thread_index];
+                                       if (!search)
+                                       {
+                                           search.emplace(raptor_->CreateSearch());
+                                       }
+                                       raptor_->Run(origins[row], destinations.size() == 1 ? std::optional<size_t>(destinations[0]) : std::nullopt, std::numeric_limits<double>::infinity(), *search);
+                                       for (size_t column = 0; column < destinations.size(); ++column)
+                                       {
+                                           total_times[row][column] = search->GetTime(destinations[column]);
+                                       } });
+            return total_times;
+        }
+
+        // Одна строка — один поиск от остановки отправления, который останавливается, когда найдены все остановки
+        // назначения. Схема с корзинами (обратные поиски от назначений, прямые от отправлений, встреча в корзинах)
+        // выигрывает только на иерархии, обрезающей пространства поиска; на плоском графе каждый её поиск — полный,
+        // и их было бы |origins| + |destinations| против |origins| здесь. Иерархией служат метки хабов (hub_labels выше)
+        std::vector<std::optional<graph::Dijkstra<double>>> searches(std::max<size_t>(1, threads_count));
+        parallel::ForEachIndex(origins.size(), searches.size(), [&](size_t row, size_t thread_index)
+                               {
+                                   auto &search = searches[thread_index];
+                                   if (!search)
+                                   {
+                                       search.emplace(*graph_);
+                                   }
+                                   search->BuildTree(GetStopVertex(origins[row]), targets);
+                                   for (size_t column = 0; column < targets.size(); ++column)
+                                   {
+                                       total_times[row][column] = search->GetWeight(targets[column]);
+                                   } });
+        return total_times;
+    }
+
+    std::vector<guide::ReachableStop> TransportRouter::GetReachableStops(size_t from, double max_time, RouteSearch &search) const
+    {
+        std::vector<guide::ReachableStop> stops;
+        if (pareto_profiles_)
+        {
+            std::vector<std::pair<double, size_t>> reachable;
+            for (size_t stop = 0; stop < GetStopsCount(); ++stop)
+            {
+                const auto time = pareto_profiles_->GetTotalTime(from, stop, bus_wait_time_, bus_velocity_);
+                if (time && !(max_time < *time))
+                {
+                    reachable.emplace_back(*time, stop);
+                }
+            }
+            std::sort(reachable.begin(), reachable.end());
+            for (const auto &[time, stop] : reachable)
+            {
+                stops.push_back({stops_by_id_[stop], time});
+            }
+            return stops;
+        }
+        // Поиск ограничен бюджетом времени, поэтому просматривается только окрестность from
+        if (raptor_)
+        {
+            raptor_->Run(from, std::nullopt, max_time, *search.raptor_);
+            for (const size_t stop : search.raptor_->GetReachedStops())
+            {
+                stops.push_back({stops_by_id_[stop], *search.raptor_->GetTime(stop)});
+            }
+            return stops;
         }
-        graph::Router<double>::RouteInfo info = route.value();
-        for (const auto &edge : info.edges)
+        auto &dijkstra = *search.dijkstra_;
+        dijkstra.BuildBoundedTree(GetStopVertex(from), max_time);
+        for (const graph::VertexId vertex : dijkstra.GetSettledVertices())
+        {
+            if (vertex >= GetStopsCount())
+            {
+                stops.push_back({stops_by_id_[vertex - GetStopsCount()], *dijkstra.GetWeight(vertex)});
+            }
+        }
+        return stops;
+    }
+
+    RouteItems TransportRouter::MakeRouteItems(const std::vector<graph::EdgeId> &edges) const
+    {
+        RouteItems route_info;
+        route_info.reserve(edges.size());
+        for (const auto &edge : edges)
         {
             const auto &graph_edge = graph_->GetEdge(edge);
             if (std::abs(static_cast<int>(graph_edge.from - graph_edge.to)) == GetStopsCount())
             {
-                // std::cout << "Wait" << std::endl;
                 route_info.push_back(guide::RouteWaitInfo{GetStopName(graph_edge.from), GetBusTimeWait()});
             }
             else
             {
-                // std::cout << "Bus" << std::endl;
                 route_info.push_back(guide::RouteBusInfo{GetBus(graph_edge), GetSpanCount(graph_edge), graph_edge.weight});
             }
         }
         return route_info;
     }
 
+    RouteItems TransportRouter::MakeRouteItems(const std::vector<RaptorLeg> &legs, int bus_wait_time) const
+    {
+        RouteItems route_info;
+        route_info.reserve(2 * legs.size());
+        for (const auto &leg : legs)
+        {
+            route_info.push_back(guide::RouteWaitInfo{std::string(stops_by_id_[leg.from_stop]), bus_wait_time});
+            route_info.push_back(guide::RouteBusInfo{std::string(leg.bus), leg.span_count, leg.time});
+        }
+        return route_info;
+    }
+
     void TransportRouter::PrintGraph()
     {
-        graph_->Print();
+        if (graph_)
+        {
+            graph_->Print();
+        }
     }
 
     std::string TransportRouter::GetStopName(size_t edge_id) const
@@ -115,9 +1008,7 @@ namespace router
         {
             edge_id -= stops_names_.size();
         }
-        auto it = stops_names_.begin();
-        advance(it, edge_id);
-        return std::string(*it);
+        return std::string(stops_by_id_[edge_id]);
     }
 
     int TransportRouter::GetBusTimeWait() const
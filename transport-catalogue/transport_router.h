@@ -3,22 +3,168 @@
 #include "transport_catalogue.h"
 #include "router.h"
 #include "graph.h"
+#include "dijkstra.h"
+#include "landmarks.h"
+#include "hub_labels.h"
+#include "overlay.h"
+#include "raptor.h"
+#include "pareto_profiles.h"
+#include "profile_cache.h"
 #include "domain.h"
+#include "geo.h"
 
 #include <optional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 #include <string>
 
 namespace router
 {
+    using RouteItems = std::vector<std::variant<guide::RouteWaitInfo, guide::RouteBusInfo>>;
+
+    // Способ поиска маршрутов
+    enum class RoutingEngine
+    {
+        ALL_PAIRS,         // graph::Router: таблица кратчайших путей между всеми парами вершин
+        ALL_PAIRS_BLOCKED, // та же таблица, предподсчёт блочным Флойдом—Уоршеллом на нескольких потоках
+        DIJKSTRA,          // поиск Дейкстры на каждый запрос, без предподсчёта
+        ASTAR,             // A* на каждый Route-запрос: нижняя оценка по расстоянию по прямой
+        ALT,               // A* с оценками по предподсчитанным расстояниям до опорных вершин
+        BIDIRECTIONAL,     // двунаправленный поиск Дейкстры на каждый Route-запрос, без предподсчёта
+        HUB_LABELS,        // метки хабов: время в пути — слияние двух коротких отсортированных меток
+        RAPTOR,            // поиск по линиям автобусов раундами пересадок, без графа
+        OVERLAY,           // многоуровневый оверлей: поиск по графу только в ячейках концов маршрута, между ними — по кликам
+        PARETO_PROFILES,   // таблица Парето-профилей (посадки, расстояние) всех пар: ответ при любых bus_wait_time и bus_velocity
+        AUTO               // выбор по размеру графа в пределах бюджетов памяти и времени предподсчёта
+    };
+
+    std::string_view GetEngineName(RoutingEngine engine);
+
+    struct RoutingSettings
+    {
+        int bus_wait_time = 0;
+        int bus_velocity = 0;
+        RoutingEngine engine = RoutingEngine::ALL_PAIRS;
+        size_t threads_count = 1; // потоки для предподсчёта
+        // Бюджеты для AUTO: память под структуры поиска сверх графа и время предподсчёта
+        size_t memory_budget_bytes = size_t{1} << 30;
+        double preprocessing_budget_seconds = 30.0;
+        size_t landmarks_count = 16; // опорные вершины для ALT
+        std::string hub_labels_file = {}; // файл меток хабов: читается, если построен для того же графа, иначе перезаписывается
+        size_t overlay_cell_size = 512; // остановок в ячейке нижнего уровня оверлея (не больше)
+        size_t overlay_levels = 2;      // уровней оверлея; ячейка следующего уровня объединяет 8 ячеек предыдущего
+        size_t profile_cache_size = 4096; // маршрутов Route-запросов со своим профилем в кэше
+    };
+
+    // Оценка затрат способа поиска на графе заданного размера
+    struct EngineEstimate
+    {
+        RoutingEngine engine;
+        size_t memory_bytes;
+        double preprocessing_seconds;
+    };
+
+    struct EngineSelection
+    {
+        RoutingEngine engine;
+        std::string reason;
+    };
+
+    // Подготовка способа поиска для сводки --stats
+    struct RouterBuildReport
+    {
+        RoutingEngine engine = RoutingEngine::ALL_PAIRS;
+        std::string engine_selection; // почему AUTO выбрал способ; пусто, если способ задан в настройках
+        std::optional<graph::HubLabelsStats> hub_labels;
+        bool hub_labels_loaded = false; // метки прочитаны из hub_labels_file, а не построены
+        std::optional<graph::OverlayStats> overlay;
+        std::optional<ParetoProfilesStats> pareto_profiles;
+    };
+
+    // Оценки в порядке предпочтения: от самых быстрых запросов к самым дешёвым в подготовке
+    std::vector<EngineEstimate> EstimateRoutingEngines(size_t vertex_count, size_t edge_count, size_t threads_count, size_t landmarks_count = RoutingSettings{}.landmarks_count);
+
+    // Первый по предпочтению способ, укладывающийся в бюджеты настроек. hub_labels, overlay и pareto_profiles
+    // не оцениваются и не выбираются: их память и время подготовки зависят не от размера графа, а от строения сети
+    // (размера меток, числа остановок на границах ячеек, числа Парето-маршрутов на пару) и известны только после построения
+    EngineSelection SelectRoutingEngine(size_t vertex_count, size_t edge_count, const RoutingSettings &settings);
+
     class TransportRouter
     {
     public:
-        TransportRouter(int bus_wait_time, int bus_velocity, guide::TransportCatalogue &transport_catalogue);
+        // Буферы поиска одного потока; создаются через CreateSearch
+        class RouteSearch
+        {
+        public:
+            // Просмотренные вершины и рёбра (для RAPTOR — улучшения времени остановок и просмотренные позиции линий)
+            const graph::SearchStats &GetStats() const;
+
+        private:
+            friend class TransportRouter;
+
+            std::optional<graph::Dijkstra<double>> dijkstra_;
+            std::optional<Raptor::Search> raptor_;
+            std::optional<graph::Overlay<double>::Search> overlay_;
+            std::optional<Raptor::Search> profile_raptor_; // для запросов со своим профилем, создаётся при первом
+        };
+
+        // Справочник должен жить дольше маршрутизатора: по нему строятся линии для запросов со своим профилем
+        TransportRouter(const RoutingSettings &settings, guide::TransportCatalogue &transport_catalogue);
+
+        std::optional<RouteItems> GetRouteInfo(std::string_view from, std::string_view to) const;
+
+        std::optional<RouteItems> GetRouteInfo(size_t from, size_t to) const;
 
-        std::optional<std::vector<std::variant<guide::RouteWaitInfo, guide::RouteBusInfo>>> GetRouteInfo(std::string_view from, std::string_view to) const;
+        std::optional<RouteItems> GetRouteInfo(size_t from, size_t to, RouteSearch &search) const;
+
+        // Маршрут при своих времени ожидания и скорости автобусов. Граф под профиль не строится: PARETO_PROFILES
+        // отвечает по таблице профилей, остальные способы — поиском RAPTOR, применяющим профиль при просмотре линий.
+        // Ответы поиска хранятся в кэше профилей
+        std::optional<RouteItems> GetRouteInfo(size_t from, size_t to, const RoutingProfile &profile, RouteSearch &search) const;
+
+        // Маршруты из одной остановки во все to: без таблицы всех пар строится одно дерево кратчайших путей
+        std::vector<std::optional<RouteItems>> GetRoutesInfo(size_t from, const std::vector<size_t> &to, RouteSearch &search) const;
+
+        // Матрица времён в пути origins x destinations (nullopt — маршрута нет); строки считаются на threads_count потоках.
+        // По таблице всех пар, меткам хабов и Парето-профилям — без поиска, иначе один поиск на строку
+        std::vector<std::vector<std::optional<double>>> GetTotalTimes(const std::vector<size_t> &origins, const std::vector<size_t> &destinations, size_t threads_count) const;
+
+        // Остановки, до которых можно добраться из from не дольше чем за max_time, в порядке времени в пути
+        std::vector<guide::ReachableStop> GetReachableStops(size_t from, double max_time, RouteSearch &search) const;
+
+        RouteSearch CreateSearch() const;
+
+        // Новые время ожидания и скорость автобусов без повторного предподсчёта. PARETO_PROFILES только запоминает их;
+        // у OVERLAY граф перестраивается с теми же рёбрами и пересчитываются клики. Для остальных способов — std::logic_error
+        void SetRoutingParameters(int bus_wait_time, int bus_velocity, guide::TransportCatalogue &transport_catalogue, size_t threads_count = 1);
+
+        RoutingEngine GetEngine() const;
+
+        RouterBuildReport GetBuildReport() const;
+
+        // Время ожидания и скорость автобусов из настроек
+        RoutingProfile GetRoutingProfile() const;
+
+        std::vector<ProfileCacheStats> GetProfileCacheStats() const;
+
+        // Память по частям: граф, таблица всех пар (routes_table), bus_edges, индекс остановок и структуры
+        // способа поиска. RAPTOR, метки хабов, оверлей и Парето-профили сообщают только байты, без числа блоков
+        std::vector<memory::SubsystemUsage> GetMemoryUsage() const;
+
+        // Отвечает ли предподсчитанный индекс (таблица всех пар, метки хабов, Парето-профили) на запросы без поиска по графу
+        bool HasRoutesTable() const;
+
+        // Ищется ли одиночный маршрут отдельным поиском до цели (A*, ALT, двунаправленный поиск, RAPTOR, оверлей)
+        bool HasPointToPointSearch() const;
+
+        // Номер остановки в графе или nullopt, если остановка неизвестна
+        std::optional<size_t> FindStopId(std::string_view stop) const;
+
+        // Название остановки по номеру из FindStopId
+        std::string_view GetStopNameById(size_t stop) const;
 
         void PrintGraph();
 
@@ -27,13 +173,56 @@ namespace router
     private:
         int bus_wait_time_ = 0;
         int bus_velocity_ = 0;
+        RoutingEngine engine_ = RoutingEngine::ALL_PAIRS;
+        std::string engine_selection_;
+        bool hub_labels_loaded_ = false;
         std::set<std::string_view> stops_names_;
+        std::vector<std::string_view> stops_by_id_;
+        std::unordered_map<std::string_view, size_t> stops_ids_;
         std::map<std::tuple<size_t, size_t, double>, std::pair<std::string, int>> bus_edges_;
         std::unique_ptr<graph::DirectedWeightedGraph<double>> graph_;
         std::unique_ptr<graph::Router<double>> router_;
+        std::unique_ptr<graph::Landmarks<double>> landmarks_;
+        std::unique_ptr<graph::HubLabels<double>> hub_labels_;
+        std::unique_ptr<Raptor> raptor_;
+        std::unique_ptr<graph::Overlay<double>> overlay_;
+        std::unique_ptr<ParetoProfiles> pareto_profiles_;
+        // Линии для запросов со своим профилем, если основной способ не RAPTOR. Строятся при первом таком
+        // запросе: запросы идут на нескольких потоках, поэтому — под profile_raptor_once_
+        const guide::TransportCatalogue *transport_catalogue_ = nullptr;
+        mutable std::once_flag profile_raptor_once_;
+        mutable std::unique_ptr<Raptor> profile_raptor_;
+        mutable ProfileCache<std::optional<RouteItems>> profile_cache_;
+        std::vector<guide::stop_coordinate::Coordinates> stops_coordinates_;
+        double geo_time_factor_ = 0.0; // минуты пути на метр расстояния по прямой, не больше чем на любом перегоне
+
+        // Нижние оценки времени в пути для A*: минимальное по всем перегонам отношение
+        // дорожного расстояния к расстоянию по прямой, делённое на скорость автобуса
+        void InitializeGeoBound(const guide::TransportCatalogue &transport_catalogue);
+
+        double GetGeoLowerBound(graph::VertexId vertex, guide::stop_coordinate::Coordinates target) const;
+
+        const Raptor &GetProfileRaptor() const;
+
+        // Метки хабов из файла или новые (с сохранением в файл)
+        void InitializeHubLabels(const std::string &file);
+
+        // Разбиение остановок на ячейки и клики оверлея
+        void InitializeOverlay(const guide::TransportCatalogue &transport_catalogue, const RoutingSettings &settings);
+
+        // Граф с вершинами «на остановке» и «в ожидании автобуса»; для RAPTOR и Парето-профилей не строится.
+        // Списки входящих рёбер — только для способов с поиском в обратную сторону
+        void BuildGraph(guide::TransportCatalogue &transport_catalogue);
 
         size_t GetStopNumber(std::string_view stop) const;
 
+        // Вершина «на остановке, до ожидания автобуса»: из неё начинаются и в ней заканчиваются маршруты
+        graph::VertexId GetStopVertex(size_t stop) const;
+
+        RouteItems MakeRouteItems(const std::vector<graph::EdgeId> &edges) const;
+
+        RouteItems MakeRouteItems(const std::vector<RaptorLeg> &legs, int bus_wait_time) const;
+
         int GetDistance(guide::TransportCatalogue &transport_catalogue, const std::vector<std::string_view> &stops, size_t from, size_t to) const;
 
         std::string GetStopName(size_t edge_id) const;